@@ -0,0 +1,154 @@
+/*
+** CartBot control software
+** Stephen Tarr
+** FRC Team 1425 "Error Code Xero"
+**
+** This code depends on F Malpartida's NewLiquidCrystal library:
+** https://bitbucket.org/fmalpartida/new-liquidcrystal 
+*/
+#include <avr/interrupt.h>
+#include "AdcSampler.h"
+
+static const uint8_t adcPins[ADC_CHANNELS] = {
+    JOYX_PIN, JOYY_PIN, VBAT_PIN, VENBL_PIN
+};
+
+#ifdef ADC_INTERRUPT
+
+// AVcc reference, as analogRead() uses; clk/128 = 125 kHz ADC clock
+#define	ADC_REFERENCE	(1 << REFS0)
+#define	ADC_PRESCALE	((1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0))
+
+// interrupt side
+static uint16_t ring[ADC_CHANNELS][ADC_OVERSAMPLE];
+static uint16_t sum[ADC_CHANNELS];
+static uint8_t channel;			// being converted
+static uint8_t slot;			// ring position of this round
+static uint16_t rounds;
+static bool primed;			// the rings have been filled once
+static uint8_t filled;
+
+// handoff: odd while the interrupt is writing 'shared'
+static volatile uint8_t seq;
+static volatile AdcSnapshot shared;
+
+ISR(ADC_vect)
+{
+    uint16_t value = ADC;
+    uint8_t c = channel;
+
+    // start the next conversion first so it overlaps the bookkeeping
+    if (++channel == ADC_CHANNELS) {
+	channel = 0;
+    }
+    ADMUX = ADC_REFERENCE | adcPins[channel];
+    ADCSRA |= (1 << ADSC);
+
+    if (!primed) {
+	// the first conversion fills the whole ring, so the sums are
+	// usable from the first round on
+	for (uint8_t i = 0; i < ADC_OVERSAMPLE; i++) {
+	    ring[c][i] = value;
+	}
+	sum[c] = value * ADC_OVERSAMPLE;
+    } else {
+	uint16_t *old = &ring[c][slot];
+	sum[c] += value - *old;
+	*old = value;
+    }
+
+    if (channel == 0) {
+	slot = (slot + 1) & (ADC_OVERSAMPLE - 1);
+	++seq;
+	for (uint8_t i = 0; i < ADC_CHANNELS; i++) {
+	    shared.sum[i] = sum[i];
+	}
+	shared.rounds = ++rounds;
+	primed = true;
+	if (filled < ADC_OVERSAMPLE) {
+	    ++filled;
+	}
+	shared.filled = filled;
+	++seq;
+    }
+}
+
+void AdcSampler::Begin()
+{
+    cli();
+    memset(ring, 0, sizeof ring);
+    memset(sum, 0, sizeof sum);
+    channel = 0;
+    slot = 0;
+    rounds = 0;
+    primed = false;
+    filled = 0;
+    seq = 0;
+
+    // the digital input buffers only waste power on analog pins
+    for (uint8_t i = 0; i < ADC_CHANNELS; i++) {
+	DIDR0 |= (1 << adcPins[i]);
+    }
+    ADCSRB = 0;
+    ADMUX = ADC_REFERENCE | adcPins[0];
+    ADCSRA = (1 << ADEN) | (1 << ADSC) | (1 << ADIE) | ADC_PRESCALE;
+    sei();
+}
+
+void AdcSampler::Read( AdcSnapshot &out )
+{
+    uint8_t s;
+    do {
+	s = seq;
+	for (uint8_t i = 0; i < ADC_CHANNELS; i++) {
+	    out.sum[i] = shared.sum[i];
+	}
+	out.rounds = shared.rounds;
+	out.filled = shared.filled;
+    } while ((s & 1) || s != seq);
+}
+
+void AdcSampler::Settle( AdcSnapshot &out )
+{
+    for (;;) {
+	Read(out);
+	if (out.filled >= ADC_OVERSAMPLE) {
+	    return;
+	}
+	delayMicroseconds(ADC_ROUND_US);
+    }
+}
+
+#else // polled
+
+static uint16_t rounds;
+
+void AdcSampler::Begin()
+{
+    rounds = 0;
+}
+
+void AdcSampler::Read( AdcSnapshot &out )
+{
+    for (uint8_t i = 0; i < ADC_CHANNELS; i++) {
+	out.sum[i] = analogRead(adcPins[i]) * ADC_OVERSAMPLE;
+    }
+    out.rounds = ++rounds;
+    out.filled = ADC_OVERSAMPLE;
+}
+
+void AdcSampler::Settle( AdcSnapshot &out )
+{
+    for (uint8_t i = 0; i < ADC_CHANNELS; i++) {
+	out.sum[i] = 0;
+    }
+    for (uint8_t n = 0; n < ADC_OVERSAMPLE; n++) {
+	for (uint8_t i = 0; i < ADC_CHANNELS; i++) {
+	    out.sum[i] += analogRead(adcPins[i]);
+	}
+    }
+    out.rounds = ++rounds;
+    out.filled = ADC_OVERSAMPLE;
+}
+
+#endif
@@ -0,0 +1,62 @@
+#pragma once
+/*
+** CartBot control software
+** Stephen Tarr - FRC Team 1425 "Error Code Xero"
+**
+** This code depends on F Malpartida's NewLiquidCrystal library:
+** https://bitbucket.org/fmalpartida/new-liquidcrystal 
+*/
+#include <Arduino.h>
+#include "Hardware.h"
+
+// analog inputs, in conversion order
+enum AdcChannel {
+    ADC_JOYX,
+    ADC_JOYY,
+    ADC_VBAT,
+    ADC_VENBL,
+    ADC_CHANNELS
+};
+
+static_assert((ADC_OVERSAMPLE & (ADC_OVERSAMPLE - 1)) == 0 &&
+	      ADC_OVERSAMPLE * 1023L <= 0xFFFFL,
+	      "ADC_OVERSAMPLE must be a power of two of at most 64");
+
+#ifdef ADC_INTERRUPT
+// one round of conversions: 13 ADC clocks per channel at F_CPU / 128
+#define	ADC_ROUND_US	(ADC_CHANNELS * 13 * 128 * 1000000L / F_CPU)
+#else
+#define	ADC_ROUND_US	0
+#endif
+
+// A consistent set of readings, all channels from the same rounds.
+struct AdcSnapshot {
+    uint16_t sum[ADC_CHANNELS];	// last ADC_OVERSAMPLE conversions
+    uint16_t rounds;		// rounds of conversions so far (wraps)
+    uint8_t filled;		// rounds in the window, up to ADC_OVERSAMPLE;
+				// 0 until anything has been converted
+
+    // rounded mean in A2D units (0..1023)
+    int Value( uint8_t channel ) const
+    {
+	return (sum[channel] + ADC_OVERSAMPLE / 2) / ADC_OVERSAMPLE;
+    }
+};
+
+// Analog input sampler.  With ADC_INTERRUPT defined, the ADC-complete
+// interrupt converts the channels round and round (one conversion every
+// 104us at 16 MHz, so each channel every 416us), keeps a ring of the
+// last ADC_OVERSAMPLE conversions per channel, and publishes the running
+// sums after each round.  The main loop copies them out under a sequence
+// counter, retrying if a round was published meanwhile - interrupts are
+// never turned off.  Otherwise Read() converts every channel on the spot.
+class AdcSampler {
+public:
+    static void Begin();
+    static void Read( AdcSnapshot &out );
+
+    // a full window of conversions, for seeding filters at boot: waits
+    // for the first ADC_OVERSAMPLE rounds if they haven't gone by yet,
+    // or when polled takes that many conversions per channel
+    static void Settle( AdcSnapshot &out );
+};
@@ -0,0 +1,218 @@
+/*
+** CartBot control software
+** Stephen Tarr
+** FRC Team 1425 "Error Code Xero"
+**
+** This code depends on F Malpartida's NewLiquidCrystal library:
+** https://bitbucket.org/fmalpartida/new-liquidcrystal 
+*/
+#include <string.h>
+#include "BlackBox.h"
+#include "LoopStats.h"
+
+#define	RUN		0x80	// record is a repeat count
+#define	RUN_MAX		0x7F
+#define	SMALL		6	// nibble: delta of -SMALL..SMALL
+#define	UP		0xD	// nibble: next one is a delta beyond SMALL
+#define	DOWN		0xE	// ... or below -SMALL
+#define	MEDIUM		(SMALL + 16)
+#define	ESCAPE		0xF	// nibble: absolute value follows
+
+// nibble 'n' of a record, counting the field mask as nibbles 0 and 1
+static uint8_t GetNibble( const uint8_t *ring, uint16_t size, uint16_t at,
+			  uint8_t n )
+{
+    uint8_t b = ring[(at + n / 2) % size];
+    return (n & 1) ? (b & 0x0F) : (b >> 4);
+}
+
+uint8_t BlackBox::Decode( const uint8_t *ring, uint16_t size, uint16_t at,
+			  BlackBoxSample &s, uint8_t &count )
+{
+    uint8_t mask = ring[at];
+    if (mask & RUN) {
+	count = mask & RUN_MAX;
+	return 1;
+    }
+
+    uint8_t n = 2;
+    for (uint8_t i = 0; i < BB_FIELDS; i++) {
+	if (mask & (1 << i)) {
+	    uint8_t x = GetNibble(ring, size, at, n++);
+	    if (x == ESCAPE) {
+		int v = 0;
+		for (uint8_t k = 0; k < 3; k++) {
+		    v = (v << 4) | GetNibble(ring, size, at, n++);
+		}
+		s.v[i] = v;
+	    } else if (x == UP) {
+		s.v[i] += SMALL + 1 + GetNibble(ring, size, at, n++);
+	    } else if (x == DOWN) {
+		s.v[i] -= SMALL + 1 + GetNibble(ring, size, at, n++);
+	    } else {
+		s.v[i] += x - SMALL;
+	    }
+	}
+    }
+    count = 1;
+    return (n + 1) / 2;
+}
+
+BlackBox::BlackBox()
+{
+    Clear();
+}
+
+void BlackBox::Clear()
+{
+    tail = used = 0;
+    run = NO_RUN;
+    samples = 0;
+    skip = 0;
+    memset(&base, 0, sizeof base);
+    memset(&last, 0, sizeof last);
+    frozen = false;
+}
+
+void BlackBox::Freeze()
+{
+    frozen = true;
+}
+
+#ifdef BLACKBOX
+
+static_assert(BLACKBOX_PERIOD % CONTROL_PERIOD == 0,
+	      "BLACKBOX_PERIOD must be a multiple of CONTROL_PERIOD");
+
+static void PutNibble( uint8_t *rec, uint8_t n, uint8_t value )
+{
+    if (n & 1) {
+	rec[n / 2] |= value;
+    } else {
+	rec[n / 2] = value << 4;
+    }
+}
+
+uint8_t BlackBox::Encode( const BlackBoxSample &s, uint8_t *rec ) const
+{
+    uint8_t mask = 0;
+    uint8_t n = 2;
+
+    for (uint8_t i = 0; i < BB_FIELDS; i++) {
+	int d = s.v[i] - last.v[i];
+	if (d == 0) {
+	    continue;
+	}
+	mask |= (1 << i);
+	if (d >= -SMALL && d <= SMALL) {
+	    PutNibble(rec, n++, d + SMALL);
+	} else if (d > 0 && d <= MEDIUM) {
+	    PutNibble(rec, n++, UP);
+	    PutNibble(rec, n++, d - SMALL - 1);
+	} else if (d < 0 && d >= -MEDIUM) {
+	    PutNibble(rec, n++, DOWN);
+	    PutNibble(rec, n++, -d - SMALL - 1);
+	} else {
+	    int v = s.v[i] & 0xFFF;
+	    PutNibble(rec, n++, ESCAPE);
+	    PutNibble(rec, n++, v >> 8);
+	    PutNibble(rec, n++, (v >> 4) & 0x0F);
+	    PutNibble(rec, n++, v & 0x0F);
+	}
+    }
+    rec[0] = mask;
+    return (n + 1) / 2;
+}
+
+// make room by folding the oldest records into 'base', then copy in
+void BlackBox::Append( const uint8_t *rec, uint8_t length )
+{
+    while (used + length > BLACKBOX_BYTES) {
+	uint8_t count;
+	uint8_t n = Decode(ring, BLACKBOX_BYTES, tail, base, count);
+	if (tail == run) {
+	    run = NO_RUN;
+	}
+	tail = (tail + n) % BLACKBOX_BYTES;
+	used -= n;
+	samples -= count;
+    }
+
+    uint16_t at = (tail + used) % BLACKBOX_BYTES;
+    for (uint8_t i = 0; i < length; i++) {
+	ring[(at + i) % BLACKBOX_BYTES] = rec[i];
+    }
+    used += length;
+}
+
+void BlackBox::Record( const BlackBoxSample &s )
+{
+    if (frozen) {
+	return;
+    }
+    if (skip) {
+	--skip;
+	return;
+    }
+    skip = BLACKBOX_PERIOD / CONTROL_PERIOD - 1;
+    ++samples;
+
+    if (samples > 1 && memcmp(&s, &last, sizeof s) == 0) {
+	if (run != NO_RUN && (ring[run] & RUN_MAX) < RUN_MAX) {
+	    ++ring[run];
+	} else {
+	    uint8_t rec = RUN | 1;
+	    Append(&rec, 1);
+	    run = (tail + used - 1) % BLACKBOX_BYTES;
+	}
+	return;
+    }
+
+    uint8_t rec[1 + (BB_FIELDS * 4 + 1) / 2];
+    Append(rec, Encode(s, rec));
+    run = NO_RUN;
+    last = s;
+}
+
+static void PrintHex( Print &out, uint8_t b )
+{
+    static const char digit[] = "0123456789abcdef";
+    out.print(digit[b >> 4]);
+    out.print(digit[b & 0x0F]);
+}
+
+void BlackBox::Dump( Print &out )
+{
+    PrintP(out, PSTR("blackbox "));
+    out.print(BLACKBOX_PERIOD);
+    PrintP(out, PSTR(" ms "));
+    out.print(samples);
+    PrintP(out, frozen ? PSTR(" samples frozen") : PSTR(" samples"));
+    out.println();
+    PrintP(out, PSTR("base"));
+    for (uint8_t i = 0; i < BB_FIELDS; i++) {
+	out.print(' ');
+	out.print(base.v[i]);
+    }
+    out.println();
+    for (uint16_t i = 0; i < used; i++) {
+	PrintHex(out, ring[(tail + i) % BLACKBOX_BYTES]);
+	if (i % 32 == 31 || i == used - 1) {
+	    out.println();
+	}
+    }
+    PrintP(out, PSTR("end"));
+    out.println();
+
+    Clear();
+}
+
+#else
+
+void BlackBox::Dump( Print &out )
+{
+    PrintP(out, PSTR("blackbox off"));
+    out.println();
+}
+
+#endif
@@ -0,0 +1,77 @@
+#pragma once
+/*
+** CartBot control software
+** Stephen Tarr - FRC Team 1425 "Error Code Xero"
+**
+** This code depends on F Malpartida's NewLiquidCrystal library:
+** https://bitbucket.org/fmalpartida/new-liquidcrystal 
+*/
+#include <Arduino.h>
+#include "Hardware.h"
+
+// what is recorded each control period
+enum BlackBoxField {
+    BB_JOYX,
+    BB_JOYY,
+    BB_VBAT,
+    BB_VENBL,
+    BB_LEFT,		// servo pulses, microseconds; 0 while detached
+    BB_RIGHT,
+    BB_STATE,
+    BB_FIELDS
+};
+
+struct BlackBoxSample {
+    int16_t v[BB_FIELDS];
+};
+
+// Flight recorder: the last few seconds of inputs and outputs, a sample
+// every BLACKBOX_PERIOD, in a ring of BLACKBOX_BYTES.  Each record is a
+// byte with a bit per field that changed, then per changed field a nibble
+// with a delta of -6..6; or 0xD or 0xE and a nibble for deltas out to
+// +/-22; or 0xF and the value in three more nibbles.  A byte with the top bit set stands for up to 127
+// samples that repeat the one before.  The oldest records
+// are dropped whole as the ring fills, folding them into 'base', so the
+// ring always decodes from its start.
+//
+// Freeze() stops recording, so entering a fault keeps what led up to
+// it; Dump() prints the ring as hex for Host/bbdecode and starts again.
+class BlackBox {
+public:
+    BlackBox();
+
+    // called every control period, keeps every BLACKBOX_PERIOD's worth;
+    // compiles away when BLACKBOX is not defined
+    void Record( const BlackBoxSample &s );
+    void Freeze();
+    bool IsFrozen() const { return frozen; }
+    void Dump( Print &out );
+
+    // expand the record at 'at' in a ring of 'size' bytes onto 's';
+    // returns its length and sets 'count' to the samples it stands for
+    static uint8_t Decode( const uint8_t *ring, uint16_t size, uint16_t at,
+			   BlackBoxSample &s, uint8_t &count );
+
+private:
+    void Clear();
+    uint8_t Encode( const BlackBoxSample &s, uint8_t *rec ) const;
+    void Append( const uint8_t *rec, uint8_t length );
+
+    enum { NO_RUN = 0xFFFF };
+
+#ifdef BLACKBOX
+    uint8_t ring[BLACKBOX_BYTES];
+#endif
+    uint16_t tail;		// oldest record
+    uint16_t used;		// bytes from there on
+    uint16_t run;		// newest record, if it is a repeat count
+    uint16_t samples;		// in the ring
+    uint8_t skip;		// control periods until the next sample
+    BlackBoxSample base;	// before the oldest record
+    BlackBoxSample last;	// after the newest
+    bool frozen;
+};
+
+#ifndef BLACKBOX
+inline void BlackBox::Record( const BlackBoxSample & ) { }
+#endif
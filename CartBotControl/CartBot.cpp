@@ -8,14 +8,26 @@
 */
 #include "CartBot.h"
 #include "Hardware.h"
-
-static PowerOnState      CartBot::powerOnState;
-static InitState         CartBot::initState;
-static DisabledState     CartBot::disabledState;
-static EnabledState      CartBot::enabledState;
-static ControlFaultState CartBot::controlFaultState;
-static BatteryFaultState CartBot::batteryFaultState;
-static TestState         CartBot::testState;
+#include "AdcSampler.h"
+
+// With the default periods control runs on even ticks, and battery and
+// display on odd ticks that never coincide (1 mod 4 vs 3 mod 4), so the
+// slow I2C display work never lands on a control tick.  Telemetry
+// follows the battery task so its frames carry fresh readings.  Enable
+// is read first thing every tick.
+const Scheduler<CartBot, CartBot::NUM_TASKS>::Task CartBot::tasks[NUM_TASKS] = {
+    { &CartBot::EnableTask, 1, 0 },
+    { &CartBot::ControlTask, CONTROL_PERIOD / LOOP_TIME, 0 },
+    { &CartBot::BatteryTask, BATTERY_PERIOD / LOOP_TIME, 1 },
+    { &CartBot::DisplayTask, DISPLAY_PERIOD / LOOP_TIME, 3 },
+    { &CartBot::TelemetryTask, TELEMETRY_PERIOD / LOOP_TIME, 1 },
+};
+
+static_assert(CONTROL_PERIOD % LOOP_TIME == 0 &&
+	      BATTERY_PERIOD % LOOP_TIME == 0 &&
+	      DISPLAY_PERIOD % LOOP_TIME == 0 &&
+	      TELEMETRY_PERIOD % LOOP_TIME == 0,
+	      "task periods must be multiples of LOOP_TIME");
 
 CartBot& CartBot::GetInstance()
 {
@@ -32,16 +44,25 @@ Display& CartBot::GetDisplay()
 }
 
 CartBot::CartBot()
-  : currentState(nullptr),
-    sampleIndex(0),
+  : scheduler(tasks),
+    machine(BuildMachine()),
+    enabled(),
+    test(),
+    joystick(),
+    joystickCal(),
+    batteryFilter(VBAT_MAX),
     joyx(0), joyy(0), vbat(0), venbl(0),
-    motorsEnabled(false),
+    inputs(),
+    events(0),
+    leftPulse(0), rightPulse(0),
     leftMotor(), rightMotor(),
-    display()
+    display(),
+    fuelGauge(),
+    stats(),
+    blackbox(),
+    telemetry()
 {
-    for (int i = 0; i < NUM_SAMPLES; i++) {
-	vbatSamples[i] = venblSamples[i] = VBAT_MAX;
-    }
+    joystickCal.Load();
 }
 
 CartBot::~CartBot()
@@ -49,36 +70,148 @@ CartBot::~CartBot()
     ;
 }
 
-
-void CartBot::ChangeState( State *newState ) {
-    // delete currentState;
-    currentState = newState;
-    currentState->ResetTimer();
-    currentState->EnterState();
+void CartBot::Start()
+{
+    SeedInputs();
+    machine.Start(*this, STATE_POWER_ON);
 }
 
 void CartBot::Run()
 {
-    ReadA2D();
-    UpdateState();
-    UpdateOutputs();
+    unsigned long start = stats.Start();
+    scheduler.Tick(*this);
+
+    // state changes wait until every task in the tick has seen the same
+    // state, but not for the LCD: flushing only sends what was composed
+    // before, and the motors shouldn't wait on I2C
+    machine.Apply(*this);
+
+    // the screen catches up a little every tick
+    unsigned long t = stats.Start();
+    display.Flush(DISPLAY_BUDGET);
+    stats.Lap(PHASE_FLUSH_DISPLAY, t);
+
+    // and the serial port, as far as its buffer has room
+    telemetry.Flush(Serial);
+
+    telemetry.Tick(stats.Lap(PHASE_TICK, start) - start);
+}
+
+// Releasing enable has to stop the motors now, not at the next control
+// period; the state machine takes the transition at the end of this tick.
+void CartBot::EnableTask()
+{
+    unsigned long t = stats.Start();
+
+    ReadEnable();
+    if (events & EVENT(INPUT_ENABLED)) {
+	machine.React(*this, events);
+    }
+    stats.Lap(PHASE_READ_ENABLE, t);
+}
+
+void CartBot::ControlTask()
+{
+    unsigned long t = stats.Start();
+
+    ReadJoystick();
+    t = stats.Lap(PHASE_READ_JOYSTICK, t);
+    events |= EVENT_TICK | inputs.UpdateJoystick(joyx, joyy, joystickCal);
+    machine.UpdateState(*this, events);
+    events = 0;
+    t = stats.Lap(PHASE_UPDATE_STATE, t);
+    machine.UpdateOutputs(*this);
+    joystickCal.Service();
+    RecordBlackBox();
+    stats.Lap(PHASE_UPDATE_OUTPUTS, t);
+}
+
+void CartBot::BatteryTask()
+{
+    unsigned long t = stats.Start();
+
+    ReadBattery();
+    stats.Lap(PHASE_READ_BATTERY, t);
+}
+
+void CartBot::DisplayTask()
+{
+    unsigned long t = stats.Start();
+
     UpdateDisplay();
+    stats.Lap(PHASE_UPDATE_DISPLAY, t);
+}
+
+void CartBot::TelemetryTask()
+{
+    unsigned long t = stats.Start();
+
+    TelemetryFrame f;
+    f.ms = millis();
+    f.state = machine.Current();
+    f.inputs = inputs.Bits();
+    f.joyx = joyx;
+    f.joyy = joyy;
+    f.vbat = vbat;
+    f.venbl = venbl;
+    f.left = leftPulse;
+    f.right = rightPulse;
+    f.overruns = stats.overruns;
+    telemetry.Send(f);
+    stats.Lap(PHASE_TELEMETRY, t);
+}
+
+LoopStats& CartBot::GetStats()
+{
+    return stats;
+}
+
+JoystickCal& CartBot::GetJoystickCal()
+{
+    return joystickCal;
 }
 
-void CartBot::UpdateState()
+BlackBox& CartBot::GetBlackBox()
 {
-    currentState->UpdateState();
+    return blackbox;
 }
 
-void CartBot::UpdateOutputs()
+Telemetry& CartBot::GetTelemetry()
 {
-    currentState->UpdateOutputs();
+    return telemetry;
 }
 
+void CartBot::RecordBlackBox()
+{
+    BlackBoxSample s;
+    s.v[BB_JOYX] = joyx;
+    s.v[BB_JOYY] = joyy;
+    s.v[BB_VBAT] = vbat;
+    s.v[BB_VENBL] = venbl;
+    s.v[BB_LEFT] = leftPulse;
+    s.v[BB_RIGHT] = rightPulse;
+    s.v[BB_STATE] = machine.Current();
+    blackbox.Record(s);
+}
+
+StateId CartBot::GetState() const
+{
+    return (StateId) machine.Current();
+}
+
+void CartBot::DumpStates( ::Print &out ) const
+{
+    machine.Dump(out, "CartBot");
+}
+
+// One frame: the banner is up only while the state asks for it each
+// time, and the LCD sees the composed result, not the drawing.
 void CartBot::UpdateDisplay()
 {
-    currentState->UpdateDisplay();
+    display.Show(REGION_BANNER, false);
+    machine.UpdateDisplay(*this);
     ShowFuelGauge();
+    display.Commit();
 }
 
 ////////////////////////////////////////////////
@@ -87,35 +220,56 @@ void CartBot::UpdateDisplay()
 //
 ////////////////////////////////////////////////
 
-void CartBot::ReadA2D()
+void CartBot::ReadJoystick()
 {
-    joyx = analogRead(JOYX_PIN);
-    joyy = analogRead(JOYY_PIN);
-    vbatSamples[sampleIndex] = analogRead(VBAT_PIN);
-    venblSamples[sampleIndex] = analogRead(VENBL_PIN);
-    if (++sampleIndex >= NUM_SAMPLES) {
-	sampleIndex = 0;
-    }
+    AdcSnapshot adc;
+    AdcSampler::Read(adc);
+    joystick.Update(adc);
+    joyx = joystick.X();
+    joyy = joystick.Y();
+    joystickCal.Track(joyx, joyy);
+}
 
-    unsigned long sumbat = 0;
-    unsigned long sumenbl = 0;
-    for (int i = 0; i < NUM_SAMPLES; i++) {
-	sumbat += (unsigned long) vbatSamples[i];
-	sumenbl += (unsigned long) venblSamples[i];
-    }
-    vbat = (sumbat + NUM_SAMPLES/2) / NUM_SAMPLES;
-    venbl = (sumenbl + NUM_SAMPLES/2) / NUM_SAMPLES;
-
-#ifdef SERIAL_DEBUG
-    static int slow = 0;
-    if (++slow >= 100) {
-	Serial.print(" x "); Serial.print(joyx);
-	Serial.print(" y "); Serial.print(joyy);
-	Serial.print(" b "); Serial.print(vbat);
-	Serial.print(" e "); Serial.println(venbl);
-	slow = 0;
-    }
-#endif
+// The ADC has been converting since AdcSampler::Begin(), all through
+// the LCD's power-up delay in the constructor.  Seed the filters from
+// that, rather than let the battery average climb down from VBAT_MAX
+// for a second, so the inputs are right from the first tick.
+void CartBot::SeedInputs()
+{
+    AdcSnapshot adc;
+    AdcSampler::Settle(adc);
+
+    joystick.Update(adc);
+    joyx = joystick.X();
+    joyy = joystick.Y();
+
+    batteryFilter.Fill(adc.Value(ADC_VBAT));
+    vbat = batteryFilter.Average(CH_VBAT);
+    venbl = adc.Value(ADC_VENBL);
+
+    events |= inputs.Settle(vbat, venbl, joyx, joyy, joystickCal);
+}
+
+void CartBot::ReadBattery()
+{
+    AdcSnapshot adc;
+    AdcSampler::Read(adc);
+
+    int sample[NUM_BATTERY_CHANNELS];
+    sample[CH_VBAT] = adc.Value(ADC_VBAT);
+    batteryFilter.Add(sample);
+
+    vbat = batteryFilter.Average(CH_VBAT);
+    events |= inputs.UpdateBattery(vbat);
+}
+
+void CartBot::ReadEnable()
+{
+    AdcSnapshot adc;
+    AdcSampler::Read(adc);
+
+    venbl = adc.Value(ADC_VENBL);
+    events |= inputs.UpdateEnable(venbl, vbat);
 }
 
 ////////////////////////////////////////////////
@@ -142,28 +296,31 @@ int CartBot::GetVEnbl() const
 
 bool CartBot::IsLowBattery() const
 {
-    return (vbat < VBAT_LOW);
+    return inputs.Is(INPUT_LOW_BATTERY);
 }
 
 bool CartBot::IsChargeNeeded() const
 {
-    return (vbat < VBAT_MIN);
+    return inputs.Is(INPUT_CHARGE_NEEDED);
 }
 
 bool CartBot::IsEnabled() const
 {
-    return (abs(venbl - vbat) < NUM_SAMPLES);
+    return inputs.Is(INPUT_ENABLED);
 }
 
 bool CartBot::IsJoystickCentered() const
 {
-    return (abs(joyx - 512) < DEADBAND) && (abs(joyy - 512) < DEADBAND);
+    return !inputs.Is(INPUT_OFF_CENTER);
 }
 
 ////////////////////////////////////////////////
 
 void CartBot::SetMotorSpeed(int left, int right)
 {
+    leftPulse = left;
+    rightPulse = right;
+
     leftMotor.writeMicroseconds(left);
     if (!leftMotor.attached()) {
 	leftMotor.attach(LEFTMOTOR_PIN, 1000, 2000);
@@ -177,6 +334,7 @@ void CartBot::SetMotorSpeed(int left, int right)
 
 void CartBot::DisableMotors()
 {
+    leftPulse = rightPulse = 0;
     leftMotor.writeMicroseconds(1500);
     leftMotor.detach();
     rightMotor.writeMicroseconds(1500);
@@ -187,30 +345,15 @@ void CartBot::DisableMotors()
 
 void CartBot::ShowBatteryStatus()
 {
-    if (CartBot::GetInstance().IsLowBattery())
-    {
-	display.Print(2, "    Low Battery     ");
-    }
-    else
+    if (IsLowBattery())
     {
-	display.Print(2, "                    ");
+	display.Print(REGION_BANNER, 0, FLASH_ROW("    Low Battery     "));
+	display.Show(REGION_BANNER, true);
     }
 }
 
 void CartBot::ShowFuelGauge()
 {
-    char fuel[21];
-
-    int vbar = 20 * (vbat - VBAT_MIN) / (VBAT_MAX - VBAT_MIN);
-    if (vbar < 0) vbar = 0;
-    if (vbar > 19) vbar = 19;
-    for (int i = 0; i <= vbar; i++) {
-	fuel[i] = (i % 5 == 0) ? CHAR_VERTICAL : CHAR_HORIZONTAL;
-    }
-    for (int i = vbar+1; i < 20; i++) {
-	fuel[i] = ' ';
-    }
-    fuel[20] = '\0';
-    display.Print(3,fuel);
+    fuelGauge.Show(display, vbat);
 }
 
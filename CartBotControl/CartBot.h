@@ -9,6 +9,16 @@
 #include <Servo.h>
 #include "State.h"
 #include "Display.h"
+#include "FuelGauge.h"
+#include "LoopStats.h"
+#include "MovingAverage.h"
+#include "JoystickFilter.h"
+#include "JoystickCal.h"
+#include "InputEvents.h"
+#include "BlackBox.h"
+#include "Telemetry.h"
+#include "Scheduler.h"
+#include "StateMachine.h"
 
 #define	NUM_SAMPLES	50	// for averaging
 
@@ -30,8 +40,10 @@ public:
     bool IsChargeNeeded() const;
     bool IsEnabled() const;
     bool IsJoystickCentered() const;
+    StateId GetState() const;
 
-    void ChangeState( State *newState );
+    // enter the power-on state
+    void Start();
 
     void SetMotorSpeed( int l, int r );
     void DisableMotors();
@@ -41,37 +53,99 @@ public:
 
     void Run();
 
-public:
-    static PowerOnState      powerOnState;
-    static InitState         initState;
-    static DisabledState     disabledState;
-    static EnabledState      enabledState;
-    static ControlFaultState controlFaultState;
-    static BatteryFaultState batteryFaultState;
-    static TestState         testState;
+    LoopStats& GetStats();
+    JoystickCal& GetJoystickCal();
+    BlackBox& GetBlackBox();
+    Telemetry& GetTelemetry();
+
+    // the state diagram, for Graphviz
+    void DumpStates( ::Print &out ) const;
 
 private:
-    void ReadA2D();
-    void UpdateState();
-    void UpdateOutputs();
+    friend class CartBench;	// host microbenchmarks, Host/cartbench.cpp
+
+    // tasks run by the scheduler, each at its own period
+    void EnableTask();
+    void ControlTask();
+    void BatteryTask();
+    void DisplayTask();
+    void TelemetryTask();
+
+    void ReadEnable();
+    void ReadJoystick();
+    void ReadBattery();
+    void SeedInputs();
     void UpdateDisplay();
+    void RecordBlackBox();
+
+    // state actions and transition guards, in State.cpp
+    void EnterPowerOn();
+    void EnterInit();
+    void UpdateInit();
+    void EndInit();
+    void EnterDisabled();
+    void EnterEnabled();
+    void UpdateOutputsEnabled();
+    void UpdateDisplayEnabled();
+    void EnterControlFault();
+    void UpdateOutputsControlFault();
+    void EnterBatteryFault();
+    void EnterTest();
+    void UpdateTest();
+    void UpdateOutputsTest();
+    void UpdateDisplayTest();
+
+    bool IsTestPressed() const;
+    bool IsPowerOnDone() const;
+    bool IsInitDone() const;
+    bool IsControlActive() const;
+    bool IsJoystickOffCenter() const;
+    bool IsDisabled() const;
+    bool IsControlReleased() const;
+
+    enum { NUM_TASKS = 5 };
+    static const Scheduler<CartBot, NUM_TASKS>::Task tasks[NUM_TASKS];
+    Scheduler<CartBot, NUM_TASKS> scheduler;
 
     // current operating mode/state
-    State *currentState;
+    enum { NUM_TRANSITIONS = 12 };
+    typedef StateMachine<CartBot, NUM_STATES, NUM_TRANSITIONS> Machine;
+    static Machine BuildMachine();	// the tables, in State.cpp
+    Machine machine;
+    EnabledData enabled;
+    TestData test;
 
-    // sample buffer for averaging
-    int vbatSamples[NUM_SAMPLES];
-    int venblSamples[NUM_SAMPLES];
-    int sampleIndex;
+    // joystick oversampling and low-pass
+    JoystickFilter joystick;
+    JoystickCal joystickCal;
+
+    // battery averaging; enable is read every tick instead
+    enum { CH_VBAT, NUM_BATTERY_CHANNELS };
+    MovingAverage<NUM_SAMPLES, NUM_BATTERY_CHANNELS> batteryFilter;
 
     // inputs in A2D units (0..1023)
     int joyx, joyy, vbat, venbl;
 
-    // outputs in microseconds (10000..20000)
-    bool motorsEnabled;
+    // debounced conditions on them, and the events not yet seen by the
+    // state machine
+    InputEvents inputs;
+    uint8_t events;
+
+    // outputs in microseconds (1000..2000), 0 while detached
+    int leftPulse, rightPulse;
     Servo leftMotor, rightMotor;
 
     // display
     Display display;
+    FuelGauge fuelGauge;
+
+    // loop timing
+    LoopStats stats;
+
+    // the last few seconds, for after a fault
+    BlackBox blackbox;
+
+    // inputs, outputs and timing as they happen
+    Telemetry telemetry;
 };
 
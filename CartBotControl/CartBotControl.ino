@@ -8,15 +8,16 @@
 */
 #include "CartBot.h"
 #include "Hardware.h"
+#include "Ticker.h"
+#include "AdcSampler.h"
 
-unsigned long when;
 bool blink_state;
 int blink_count;
 
 void setup()
 {
-#ifdef SERIAL_DEBUG
-  Serial.begin(115200);
+#if defined(SERIAL_DEBUG) || defined(LOOP_STATS) || defined(TELEMETRY)
+  Serial.begin(SERIAL_BAUD);
 #endif
   
   pinMode( VBAT_PIN,       INPUT );
@@ -29,23 +30,74 @@ void setup()
   pinMode( TEST_PIN,       INPUT_PULLUP );
   pinMode( BLINKY,         OUTPUT );
 
-  CartBot::GetInstance().ChangeState(&CartBot::powerOnState);
-  when = millis() + LOOP_TIME;
+  AdcSampler::Begin();
+  CartBot::GetInstance().Start();
+  Ticker::Begin();
   blink_state = false;
   blink_count = 0;
 }
   
+// single-character commands from the serial port:
+//   s - print loop timing and display statistics
+//   r - reset loop timing and display statistics
+//   g - print the state diagram as a Graphviz graph
+//   b - print the black box (Host/bbdecode turns it into CSV) and restart it;
+//       only with the motors off, as printing it holds up the loop ~100ms
+//   t - start or stop the binary telemetry stream (Host/telemrx); text
+//       from the others spoils a frame or two while it runs
+void serialCommand()
+{
+  switch (Serial.read()) {
+  case 's':
+    CartBot::GetInstance().GetStats().Print(Serial);
+    CartBot::GetDisplay().Report(Serial);
+    break;
+  case 'r':
+    CartBot::GetInstance().GetStats().Reset();
+    CartBot::GetDisplay().ResetStats();
+    break;
+  case 'g':
+    CartBot::GetInstance().DumpStates(Serial);
+    break;
+  case 'b':
+    switch (CartBot::GetInstance().GetState()) {
+    case STATE_DISABLED:
+    case STATE_CONTROL_FAULT:
+    case STATE_BATTERY_FAULT:
+      CartBot::GetInstance().GetBlackBox().Dump(Serial);
+      break;
+    default:
+      Serial.println("blackbox: not while the cart may drive");
+      break;
+    }
+    break;
+  case 't':
+    {
+      Telemetry &telemetry = CartBot::GetInstance().GetTelemetry();
+      telemetry.SetOn(!telemetry.IsOn());
+    }
+    break;
+  }
+}
+
 void loop()
 {
-  unsigned long now = millis();
-  if ((long)(now - when) >= 0) {
-    when += LOOP_TIME;
+  unsigned long late;
+  if (Ticker::Take(late)) {
+    CartBot::GetInstance().GetStats().Late(late);
     if (++blink_count > BLINK_CYCLES) {
       blink_state = !blink_state;
       digitalWrite(BLINKY, blink_state);
       blink_count = 0;
     }
     CartBot::GetInstance().Run();
+  } else {
+#if defined(LOOP_STATS) || defined(TELEMETRY)
+    if (Serial.available()) {
+      serialCommand();
+    }
+#endif
+    Ticker::Idle();
   }
 }
 
@@ -9,8 +9,9 @@
 #include <assert.h>
 #include <string.h>
 #include "Display.h"
+#include "LoopStats.h"
 
-byte Display::up[8] = {
+const byte Display::up[8] PROGMEM = {
     B00100,
     B01110,
     B11111,
@@ -21,7 +22,7 @@ byte Display::up[8] = {
     B00000,
 };
 
-byte Display::down[8] = {
+const byte Display::down[8] PROGMEM = {
     B00000,
     B00000,
     B00000,
@@ -32,7 +33,7 @@ byte Display::down[8] = {
     B00100,
 };
 
-byte Display::left[8] = {
+const byte Display::left[8] PROGMEM = {
     B00000,
     B00100,
     B01100,
@@ -43,7 +44,7 @@ byte Display::left[8] = {
     B00000,
 };
 
-byte Display::right[8] = {
+const byte Display::right[8] PROGMEM = {
     B00000,
     B00100,
     B00110,
@@ -54,7 +55,7 @@ byte Display::right[8] = {
     B00000,
 };
 
-byte Display::bullet[8] = {
+const byte Display::bullet[8] PROGMEM = {
     B00000,
     B00000,
     B01110,
@@ -65,7 +66,7 @@ byte Display::bullet[8] = {
     B00000,
 };
 
-byte Display::vertical[8] = {
+const byte Display::vertical[8] PROGMEM = {
     B01110,
     B01110,
     B01110,
@@ -76,7 +77,7 @@ byte Display::vertical[8] = {
     B01110,
 };
 
-byte Display::horizontal[8] = {
+const byte Display::horizontal[8] PROGMEM = {
     B00000,
     B00000,
     B11111,
@@ -87,10 +88,20 @@ byte Display::horizontal[8] = {
     B00000,
 };
 
+// createChar() wants the bitmap in RAM
+static void CreateChar( LiquidCrystal_I2C &lcd, uint8_t code,
+			const byte *bitmap )
+{
+    uint8_t buf[8];
+    memcpy_P(buf, bitmap, sizeof buf);
+    lcd.createChar(code, buf);
+}
+
 Display::Display()
   : lcd(I2C_ADDR, EN_PIN, RW_PIN, RS_PIN,
         D4_PIN, D5_PIN, D6_PIN, D7_PIN,
-	BACKLIGHT_PIN, BACKLIGHT_POL)
+	BACKLIGHT_PIN, BACKLIGHT_POL),
+    transport(lcd)
 {
     InitDisplay();
 }
@@ -102,40 +113,287 @@ Display::~Display()
 
 void Display::InitDisplay()
 {
-    memset(msgText, 0, sizeof msgText);
+    // what lcd.clear() leaves on the screen
+    memset(layer, ' ', sizeof layer);
+    memset(desired, ' ', sizeof desired);
+    memset(shown, ' ', sizeof shown);
+    visible = (1 << REGION_STATE) | (1 << REGION_GAUGE);
+    dirty = 0;
+    for (int i = 0; i < LCD_DYNAMIC_GLYPHS; i++) {
+	slotGlyph[i] = NULL;
+    }
+    slotUsed = slotStale = 0;
+    victim = 0;
+    glyphSlot = NO_SLOT;
+    cursorRow = cursorCol = -1;
 
     lcd.begin(LCD_COLS, LCD_ROWS);
-    lcd.createChar(CHAR_UP, up);
-    lcd.createChar(CHAR_DOWN, down);
-    lcd.createChar(CHAR_LEFT, left);
-    lcd.createChar(CHAR_RIGHT, right);
-    lcd.createChar(CHAR_BULLET, bullet);
-    lcd.createChar(CHAR_VERTICAL, vertical);
-    lcd.createChar(CHAR_HORIZONTAL, horizontal);
+    CreateChar(lcd, CHAR_UP, up);
+    CreateChar(lcd, CHAR_DOWN, down);
+    CreateChar(lcd, CHAR_LEFT, left);
+    CreateChar(lcd, CHAR_RIGHT, right);
+    CreateChar(lcd, CHAR_BULLET, bullet);
+    CreateChar(lcd, CHAR_VERTICAL, vertical);
+    CreateChar(lcd, CHAR_HORIZONTAL, horizontal);
     lcd.noAutoscroll();
     lcd.clear();
     lcd.noBlink();
     lcd.noCursor();
     lcd.display();
     lcd.backlight();
+    transport.Begin();
+    ResetStats();
 }
 
-void Display::Print( int n, const char *msg )
+// placement of each region on the screen and in 'layer'
+static const struct {
+    uint8_t top;
+    uint8_t rows;
+    uint8_t layer;
+} region[NUM_REGIONS] = {
+    { 0, 3, 0 },	// REGION_STATE
+    { 2, 1, 3 },	// REGION_BANNER
+    { 3, 1, 4 },	// REGION_GAUGE
+};
+
+// Drawing only changes the region's layer; nothing reaches the LCD until
+// the next Commit(), so whatever a region goes through in between - a
+// state's EnterState() text overwritten by its first UpdateDisplay(),
+// say - costs nothing on the bus.
+void Display::Print( DisplayRegion r, int row, int col, const char *text )
 {
-    assert(n >= 0 && n < LCD_ROWS);
-    assert(strlen(msg) == LCD_COLS);
+    int len = strlen(text);
+    assert(r >= 0 && r < NUM_REGIONS);
+    assert(row >= 0 && row < region[r].rows);
+    assert(col >= 0 && col + len <= LCD_COLS);
 
-    if (strcmp(msgText[n], msg) != 0) {
-	strcpy(msgText[n], msg);
-	lcd.setCursor(0,n);
-	lcd.print(msg);
-    }
+    memcpy(layer[region[r].layer + row] + col, text, len);
+}
+
+void Display::Print( int row, int col, const char *text )
+{
+    Print(REGION_STATE, row, col, text);
+}
+
+void Display::Print( DisplayRegion r, int row, const FlashRow *msg )
+{
+    assert(r >= 0 && r < NUM_REGIONS);
+    assert(row >= 0 && row < region[r].rows);
+
+    memcpy_P(layer[region[r].layer + row], msg, LCD_COLS);
+}
+
+void Display::Print( int n, const FlashRow *msg )
+{
+    Print(REGION_STATE, n, msg);
 }
 
-void Display::Print( const char *msg0, const char *msg1, const char *msg2 )
+void Display::Print( const FlashRow *msg0, const FlashRow *msg1,
+		     const FlashRow *msg2 )
 {
     Print(0, msg0);
     Print(1, msg1);
     Print(2, msg2);
 }
 
+void Display::Show( DisplayRegion r, bool on )
+{
+    if (on) {
+	visible |= (1 << r);
+    } else {
+	visible &= ~(1 << r);
+    }
+}
+
+static const uint8_t dynamicSlot[LCD_DYNAMIC_GLYPHS] = { 0 };
+
+// A glyph nobody asked for in the current frame is off the screen once
+// that frame is flushed, so its slot can be reused.
+char Display::Glyph( const uint8_t *bitmap )
+{
+    for (uint8_t i = 0; i < LCD_DYNAMIC_GLYPHS; i++) {
+	if (slotGlyph[i] == bitmap) {
+	    slotUsed |= (1 << i);
+	    return dynamicSlot[i] | 0x08;
+	}
+    }
+    for (uint8_t n = 0; n < LCD_DYNAMIC_GLYPHS; n++) {
+	uint8_t i = victim;
+	if (++victim == LCD_DYNAMIC_GLYPHS) {
+	    victim = 0;
+	}
+	if (!(slotUsed & (1 << i))) {
+	    slotGlyph[i] = bitmap;
+	    slotUsed |= (1 << i);
+	    slotStale |= (1 << i);
+	    if (i == glyphSlot) {
+		glyphSlot = NO_SLOT;	// half uploaded; start over
+	    }
+	    return dynamicSlot[i] | 0x08;
+	}
+    }
+    return ' ';
+}
+
+// Stack the visible regions row by row and mark the rows that came out
+// different from the last frame; Flush() sends just the changed cells.
+void Display::Commit()
+{
+    for (int row = 0; row < LCD_ROWS; row++) {
+	const char *top = NULL;
+	for (int r = 0; r < NUM_REGIONS; r++) {
+	    if ((visible & (1 << r)) && row >= region[r].top &&
+		row < region[r].top + region[r].rows) {
+		top = layer[region[r].layer + row - region[r].top];
+	    }
+	}
+	if (!top) {
+	    continue;
+	}
+	if (memcmp(desired[row], top, LCD_COLS) != 0) {
+	    memcpy(desired[row], top, LCD_COLS);
+	    dirty |= (1 << row);
+	}
+    }
+    slotUsed = 0;
+}
+
+// Send changed cells in screen order, a transmission at a time, until
+// 'budget' microseconds have gone.  Each transmission carries only as
+// many LCD bytes as the bus can move in the time left; the first carries
+// at least one, so a flush overruns the budget by at most one byte, and
+// only when the budget is shorter than a byte.  A cursor move is one instruction, as
+// dear on the bus as a character, so a gap of up to LCD_CURSOR_COST
+// unchanged characters after the cursor is rewritten rather than jumped.
+void Display::Flush( unsigned int budget )
+{
+    unsigned long start = micros();
+    unsigned long spent = 0;
+
+    while ((dirty || slotStale) && spent < budget) {
+	uint8_t queued[LCD_ROWS] = { 0, 0, 0, 0 };
+	uint8_t total = 0;
+	uint8_t afford = transport.Afford(budget - spent);
+	if (!afford) {
+	    if (spent) {
+		break;
+	    }
+	    afford = 1;
+	}
+
+	while ((dirty || slotStale) && total < afford) {
+	    int row = QueueNext();
+	    if (row >= 0) {
+		if (row < LCD_ROWS) {
+		    queued[row]++;
+		}
+		total++;
+	    }
+	}
+	uint8_t bytes = transport.Send();
+	unsigned long us = micros() - start - spent;
+	spent += us;
+
+	// share the transmission out by LCD bytes; glyph rows take bus
+	// time but belong to no screen row
+	for (int row = 0; row < LCD_ROWS; row++) {
+	    if (queued[row]) {
+		rowLcdBytes[row] += queued[row];
+		rowBusBytes[row] += (unsigned) bytes * queued[row] / total;
+		rowMicros[row] += us * queued[row] / total;
+	    }
+	}
+    }
+}
+
+// queue the next LCD byte; returns its row, LCD_ROWS for a glyph's, or
+// -1 if a dirty row turned out to match after all
+int Display::QueueNext()
+{
+    // glyphs first, so the cells that use them come out right
+    if (slotStale) {
+	return QueueGlyph();
+    }
+
+    int row = 0;
+    while (!(dirty & (1 << row))) {
+	row++;
+    }
+    int col = 0;
+    while (col < LCD_COLS && shown[row][col] == desired[row][col]) {
+	col++;
+    }
+    if (col == LCD_COLS) {
+	dirty &= ~(1 << row);
+	return -1;
+    }
+
+    if (row != cursorRow || col != cursorCol) {
+	if (row == cursorRow && col > cursorCol &&
+	    col - cursorCol <= LCD_CURSOR_COST) {
+	    col = cursorCol;
+	} else {
+	    transport.Cursor(col, row);
+	    cursorRow = row;
+	    cursorCol = col;
+	    return row;
+	}
+    }
+
+    transport.Data((uint8_t) desired[row][col]);
+    shown[row][col] = desired[row][col];
+    if (++cursorCol == LCD_COLS) {
+	cursorRow = -1;		// wraps to another row in DDRAM
+    }
+    return row;
+}
+
+// A glyph goes up a row at a time like any other LCD byte, so an upload
+// can straddle flushes.  The CGRAM address counter stands in for the
+// cursor meanwhile, as row LCD_ROWS.
+int Display::QueueGlyph()
+{
+    uint8_t i = 0;
+    while (!(slotStale & (1 << i))) {
+	i++;
+    }
+    if (i != glyphSlot) {
+	glyphSlot = i;
+	glyphRow = 0;
+    }
+
+    int8_t address = (dynamicSlot[i] << 3) + glyphRow;
+    if (cursorRow != LCD_ROWS || cursorCol != address) {
+	transport.CharAddress(address);
+	cursorRow = LCD_ROWS;
+	cursorCol = address;
+	return LCD_ROWS;
+    }
+
+    transport.Data(pgm_read_byte(slotGlyph[i] + glyphRow));
+    ++cursorCol;
+    if (++glyphRow == 8) {
+	slotStale &= ~(1 << i);
+	glyphSlot = NO_SLOT;
+    }
+    return LCD_ROWS;
+}
+
+void Display::ResetStats()
+{
+    for (int row = 0; row < LCD_ROWS; row++) {
+	rowLcdBytes[row] = rowBusBytes[row] = rowMicros[row] = 0;
+    }
+}
+
+void Display::Report( ::Print &out ) const
+{
+    out.println("lcd row   lcd bytes   bus bytes          us");
+    for (int row = 0; row < LCD_ROWS; row++) {
+	PrintField(out, row, 7);
+	PrintField(out, rowLcdBytes[row], 12);
+	PrintField(out, rowBusBytes[row], 12);
+	PrintField(out, rowMicros[row], 12);
+	out.println();
+    }
+}
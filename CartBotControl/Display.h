@@ -9,6 +9,7 @@
 #include <Wire.h>
 #include <LCD.h>
 #include <LiquidCrystal_I2C.h>
+#include <avr/pgmspace.h>
 
 // LCD display
 #define LCD_ROWS	4
@@ -23,6 +24,12 @@
 #define D7_PIN		7
 #define BACKLIGHT_PIN	3
 #define BACKLIGHT_POL	POSITIVE
+#define LCD_BATCHED		// pack LCD writes into full I2C transmissions
+//#define LCD_I2C_FAST		// 400 kHz I2C; beyond the PCF8574A's 100 kHz
+				// rating, though it usually copes
+
+// characters' worth of bus traffic in a cursor move
+#define LCD_CURSOR_COST	1
 
 // custom characters
 #define CHAR_UP		byte(0x01)
@@ -33,6 +40,33 @@
 #define CHAR_VERTICAL	byte(0x06)
 #define CHAR_HORIZONTAL	byte(0x07)
 
+// CGRAM slots handed out by Display::Glyph(); the glyphs above take 1-7.
+// Slot 0 goes out as code 0x08, its alias, so it can sit in a string.
+#define LCD_DYNAMIC_GLYPHS	1
+
+#include "LcdTransport.h"
+
+// Parts of the screen and who draws them.  Where regions overlap the
+// later one wins while it is shown.
+enum DisplayRegion {
+    REGION_STATE,	// rows 0-2: the current state
+    REGION_BANNER,	// row 2, over the state: battery warning
+    REGION_GAUGE,	// row 3: fuel gauge
+    NUM_REGIONS
+};
+
+// A full row of text kept in flash.  FLASH_ROW("...") refuses to compile
+// unless the literal is exactly LCD_COLS characters; the result can only
+// be handed to the Display::Print() overloads that read program memory.
+class FlashRow;
+
+template<size_t N> struct FlashRowCheck {
+    static_assert(N == LCD_COLS + 1, "LCD rows are LCD_COLS characters");
+};
+
+#define FLASH_ROW(s) \
+    ((void) FlashRowCheck<sizeof(s)>(), reinterpret_cast<const FlashRow *>(PSTR(s)))
+
 class Display {
 public:
     Display();
@@ -40,20 +74,86 @@ public:
 
     void InitDisplay();
     void ClearScreen();
-    void Print( int n, const char *msg );
-    void Print( const char *msg1, const char *msg2, const char *msg3 );
 
-    LiquidCrystal_I2C lcd;
+    // draw into the state region; rows are screen rows 0-2
+    void Print( int n, const FlashRow *msg );
+    void Print( const FlashRow *msg0, const FlashRow *msg1,
+		const FlashRow *msg2 );
+    void Print( int row, int col, const char *text );
+
+    // whole rows built in RAM; the array must hold a full row
+    template<size_t N> void Print( int n, const char (&msg)[N] )
+    {
+	(void) FlashRowCheck<N>();
+	Print(REGION_STATE, n, 0, msg);
+    }
+    template<size_t N> void Print( const char (&msg0)[N],
+				   const char (&msg1)[N],
+				   const char (&msg2)[N] )
+    {
+	Print(0, msg0);
+	Print(1, msg1);
+	Print(2, msg2);
+    }
+
+    // draw into any region; 'row' counts from the region's top
+    void Print( DisplayRegion region, int row, int col, const char *text );
+    void Print( DisplayRegion region, int row, const FlashRow *msg );
+    void Show( DisplayRegion region, bool visible );
+
+    // character code that shows 'bitmap' (8 rows in flash) in this frame; the
+    // bitmap is uploaded to a free slot by the next Flush() unless it is
+    // there already.  ' ' if every slot is taken this frame.
+    char Glyph( const uint8_t *bitmap );
+
+    // compose the regions into the frame to be shown; once per refresh
+    void Commit();
+
+    // write pending changes to the LCD for at most about 'budget'
+    // microseconds (at least one LCD byte); call every tick
+    void Flush( unsigned int budget );
+    bool IsFlushed() const { return !dirty && !slotStale; }
+
+    // LCD bytes, I2C bus bytes and microseconds spent on each row
+    void Report( ::Print &out ) const;
+    void ResetStats();
 
 private:
-    char msgText[LCD_ROWS][LCD_COLS+1];
-
-    static byte up[8];
-    static byte down[8];
-    static byte left[8];
-    static byte right[8];
-    static byte bullet[8];
-    static byte vertical[8];
-    static byte horizontal[8];
+    int QueueNext();
+    int QueueGlyph();
+
+    LiquidCrystal_I2C lcd;
+    LcdTransport transport;
+
+    // each region's own rows, REGION_STATE's first
+    enum { LAYER_ROWS = 5 };
+    char layer[LAYER_ROWS][LCD_COLS];
+    uint8_t visible;			// bit per region
+
+    char desired[LCD_ROWS][LCD_COLS];	// last committed frame
+    char shown[LCD_ROWS][LCD_COLS];	// what the LCD has
+    uint8_t dirty;			// rows where the two differ
+    int8_t cursorRow, cursorCol;	// where the next write lands
+
+    const uint8_t *slotGlyph[LCD_DYNAMIC_GLYPHS];	// resident bitmaps
+    uint8_t slotUsed;			// bit per slot: wanted this frame
+    uint8_t slotStale;			// bit per slot: still to upload
+    uint8_t victim;			// next slot to reuse
+    enum { NO_SLOT = 0xFF };
+    uint8_t glyphSlot;			// being uploaded, or NO_SLOT
+    uint8_t glyphRow;			// its next bitmap row
+
+    unsigned long rowLcdBytes[LCD_ROWS];
+    unsigned long rowBusBytes[LCD_ROWS];
+    unsigned long rowMicros[LCD_ROWS];
+
+    // in flash
+    static const byte up[8];
+    static const byte down[8];
+    static const byte left[8];
+    static const byte right[8];
+    static const byte bullet[8];
+    static const byte vertical[8];
+    static const byte horizontal[8];
 };
 
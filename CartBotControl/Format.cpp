@@ -0,0 +1,81 @@
+/*
+** CartBot control software
+** Stephen Tarr
+** FRC Team 1425 "Error Code Xero"
+**
+** This code depends on F Malpartida's NewLiquidCrystal library:
+** https://bitbucket.org/fmalpartida/new-liquidcrystal 
+*/
+#include "Format.h"
+
+void itoa4( char *buf, int n )
+{
+    int d = n % 10;
+    buf[3] = '0' + d;
+    n /= 10;
+    if (n) {
+	d = n % 10;
+	buf[2] = '0' + d;
+	n /= 10;
+	if (n) {
+	    d = n % 10;
+	    buf[1] = '0' + d;
+	    n /= 10;
+	    if (n) {
+		d = n % 10;
+		buf[0] = '0' + d;
+		n /= 10;
+		if (n) {
+		    // out of range
+		    buf[0] = buf[1] = buf[2] = buf[3] = '-';
+		}
+	    } else {
+		buf[0] = ' ';
+	    }
+	} else {
+	    buf[1] = buf[0] = ' ';
+	}
+    } else {
+	buf[2] = buf[1] = buf[0] = ' ';
+    }
+}
+
+void fixtoa2x1( char *buf, int n )
+{
+    int d = n % 10;
+    buf[3] = '0' + d;
+    buf[2] = '.';
+    n /= 10;
+    d = n % 10;
+    buf[1] = '0' + d;
+    n /= 10;
+    if (n) {
+	d = n % 10;
+	buf[0] = '0' + d;
+	n /= 10;
+	if (n) {
+	    // out of range
+	    buf[0] = buf[1] = buf[2] = buf[3] = '-';
+	}
+    } else {
+	buf[0] = ' ';
+    }
+}
+
+void fixtoa1x2( char *buf, int n )
+{
+    int d = n % 10;
+    buf[3] = '0' + d;
+    n /= 10;
+    d = n % 10;
+    buf[2] = '0' + d;
+    buf[1] = '.';
+    n /= 10;
+    d = n % 10;
+    buf[0] = '0' + d;
+    n /= 10;
+    if (n) {
+	// out of range
+	buf[0] = buf[1] = buf[2] = buf[3] = '-';
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+/*
+** CartBot control software
+** Stephen Tarr - FRC Team 1425 "Error Code Xero"
+**
+** This code depends on F Malpartida's NewLiquidCrystal library:
+** https://bitbucket.org/fmalpartida/new-liquidcrystal 
+*/
+#include <stdint.h>
+#include "Hardware.h"
+
+// A ratio num/den as a multiply and a shift, worked out by the compiler,
+// so scaling a reading costs one 32-bit multiply instead of soft float.
+// Apply() rounds half up; the multiplier is rounded up too, so an exact
+// half doesn't land a hair below.
+struct FixedScale {
+    uint32_t mul;
+    uint8_t shift;
+
+    constexpr FixedScale( unsigned long long num, unsigned long long den,
+			  uint8_t shift )
+      : mul((uint32_t) (((num << shift) + den - 1) / den)), shift(shift)
+    {
+    }
+
+    // n * mul has to fit in 32 bits
+    int Apply( unsigned int n ) const
+    {
+	return (int) (((uint32_t) n * mul + (1UL << (shift - 1))) >> shift);
+    }
+};
+
+// ADC counts to hundredths of a volt at the pin
+constexpr FixedScale ADC_CENTIVOLTS(ADC_VREF_MV / 10, 1024, 17);
+
+// ADC counts to tenths of a volt ahead of the battery divider; the ratio
+// isn't a binary fraction, and a few readings fall within 1/5000 of a
+// half, so it needs the extra bits
+constexpr FixedScale VBAT_DECIVOLTS(
+    (unsigned long long) ADC_VREF_MV / 100 * (VBAT_R_TOP + VBAT_R_BOTTOM),
+    1024ULL * VBAT_R_BOTTOM, 22);
+
+// ADC counts to tenths of a percent of full scale
+constexpr FixedScale ADC_PERMILLE(1000, 1024, 17);
+
+// servo pulse microseconds to hundredths of a millisecond
+constexpr FixedScale PULSE_CENTIMS(1, 10, 17);
+
+// Four characters, right-justified; "----" when out of range
+void itoa4( char *buf, int n );		// "dddd"
+void fixtoa2x1( char *buf, int tenths );	// "dd.d"
+void fixtoa1x2( char *buf, int hundredths );	// "d.dd"
@@ -0,0 +1,68 @@
+/*
+** CartBot control software
+** Stephen Tarr
+** FRC Team 1425 "Error Code Xero"
+**
+** This code depends on F Malpartida's NewLiquidCrystal library:
+** https://bitbucket.org/fmalpartida/new-liquidcrystal 
+*/
+#include "FuelGauge.h"
+#include "Hardware.h"
+
+#define	VBAT_RANGE	(VBAT_MAX - VBAT_MIN)
+
+// CHAR_HORIZONTAL cut to 1..4 pixel columns
+static const uint8_t partial[4][8] PROGMEM = {
+    { B00000, B00000, B10000, B10000, B10000, B10000, B00000, B00000 },
+    { B00000, B00000, B11000, B11000, B11000, B11000, B00000, B00000 },
+    { B00000, B00000, B11100, B11100, B11100, B11100, B00000, B00000 },
+    { B00000, B00000, B11110, B11110, B11110, B11110, B00000, B00000 },
+};
+
+FuelGauge::FuelGauge()
+  : level(0), low(1), high(0), tip(0)
+{
+    ;
+}
+
+void FuelGauge::Show( Display &display, int vbat )
+{
+    bool redraw = false;
+
+    if (vbat < low || vbat >= high) {
+	// as before the bar never quite empties: the lowest step shows
+	// one pixel column
+	long step = (long) (vbat - VBAT_MIN) * COLUMNS / VBAT_RANGE;
+	if (step < 0) step = 0;
+	if (step > COLUMNS - 1) step = COLUMNS - 1;
+
+	// smallest vbat giving 'step', and the one giving the next
+	low = step > 0 ? VBAT_MIN +
+	      (int) ((step * VBAT_RANGE + COLUMNS - 1) / COLUMNS) : -32767;
+	high = step < COLUMNS - 1 ? VBAT_MIN +
+	      (int) (((step + 1) * VBAT_RANGE + COLUMNS - 1) / COLUMNS) : 32767;
+
+	level = step + 1;
+	redraw = true;
+    }
+
+    // ask every frame, so the glyph keeps its slot
+    int full = level / 5;
+    int part = level % 5;
+    char code = part ? display.Glyph(partial[part - 1]) : ' ';
+    if (code != tip) {
+	tip = code;
+	redraw = true;
+    }
+
+    if (redraw) {
+	char fuel[LCD_COLS + 1];
+	for (int i = 0; i < LCD_COLS; i++) {
+	    fuel[i] = (i < full) ? ((i % 5 == 0) ? CHAR_VERTICAL : CHAR_HORIZONTAL)
+		    : (i == full) ? tip
+		    : ' ';
+	}
+	fuel[LCD_COLS] = '\0';
+	display.Print(REGION_GAUGE, 0, 0, fuel);
+    }
+}
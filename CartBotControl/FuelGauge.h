@@ -0,0 +1,26 @@
+#pragma once
+/*
+** CartBot control software
+** Stephen Tarr - FRC Team 1425 "Error Code Xero"
+**
+** This code depends on F Malpartida's NewLiquidCrystal library:
+** https://bitbucket.org/fmalpartida/new-liquidcrystal 
+*/
+#include "Display.h"
+
+// Battery bar on the bottom row, to a fifth of a cell: full cells (with
+// a tick every fifth one) and a partly filled tip drawn with a dynamic
+// glyph.  The bar is only worked out again when vbat leaves the range
+// of the level on show, so a steady battery costs two compares.
+class FuelGauge {
+public:
+    FuelGauge();
+    void Show( Display &display, int vbat );
+
+private:
+    enum { COLUMNS = LCD_COLS * 5 };
+
+    int level;			// filled pixel columns, 1..COLUMNS
+    int low, high;		// vbat range that keeps this level
+    char tip;			// code the tip was drawn with
+};
@@ -14,11 +14,27 @@
 #define VENBL_PIN	3
 
 // A2D values based on 10k/5.1k divider, 5.00V reference
+#define	ADC_VREF_MV	5000	// millivolts
+#define	VBAT_R_TOP	10000	// ohms
+#define	VBAT_R_BOTTOM	5100
 #define	VBAT_MIN	726	// 10.5V
 #define	VBAT_LOW	774	// 11.2V
 #define	VBAT_MAX	1023	// 14.8V
+#define	VBAT_HYST	8	// about 0.1V: battery thresholds clear
+				// this far above where they were set
+#define	ENABLE_PCT	94	// enable pressed: Venbl at least this
+				// percentage of the averaged Vbat
+#define	ENABLE_HYST_PCT	2	// ... and this much more to press
 
 #define	DEADBAND	85	// half-width of joystick neutral zone
+				// (uncalibrated; hands-off test always)
+#define	JOY_DEADBAND_MIN 24	// calibrated half-width, before noise
+#define	JOY_NOISE_MAX	40	// reject a noisier calibration
+#define	JOY_CENTER_TOL	6	// captured center within this plus noise
+				// of the stored one or of 512
+#define	JOY_HYST	12	// back this far inside DEADBAND to count
+				// as centered again
+#define	CAL_EEPROM_ADDR	0	// joystick calibration record
 #define	FAST		300	// threshold for "fast forward" display
 
 // digital pins
@@ -31,8 +47,34 @@
 #define	FORWARD_LIMIT	1800
 #define	REVERSE_LIMIT	1300
 
-// cycle times
-#define	LOOP_TIME	20	// main loop - milliseconds
-#define	BLINK_CYCLES	25	// multiples of LOOP_TIME
-#define	DEBOUNCE_TIME	5	// multiples of LOOP_TIME
+// cycle times - milliseconds
+#define	LOOP_TIME	5	// main loop tick
+#define	CONTROL_PERIOD	10	// joystick -> state -> motors
+#define	BATTERY_PERIOD	20	// battery averaging; enable is read every tick
+#define	DISPLAY_PERIOD	100	// LCD refresh
+#define	DISPLAY_BUDGET	1500	// microseconds of LCD writes per tick
+#define	BLINK_CYCLES	100	// multiples of LOOP_TIME
+#define	DEBOUNCE_TIME	100	// test button
+#define	EVENT_DEBOUNCE	2	// samples in a row to change an input event
+#define	ENABLE_DEBOUNCE	2	// ticks in a row to press or release enable
+//#define FAST_BOOT		// 1s splash and 0.5s hands-off control
+				// check (and joystick calibration),
+				// instead of 5s and 2s
+#define	TICK_INTERRUPT		// tick from Timer2 and sleep in between,
+				// instead of polling millis()
+#define	ADC_INTERRUPT		// convert the analog inputs from the ADC
+				// interrupt, instead of analogRead() per tick
+#define	ADC_OVERSAMPLE	16	// conversions averaged per analog input
+#define	JOY_FILTER_SHIFT 1	// joystick low-pass, y += (x - y) / 2^shift
+				// per control period; 0 turns it off
 
+// diagnostics
+#define	LOOP_STATS		// per-phase loop timing, dumped over serial
+#define	SERIAL_BAUD	115200
+#define	BLACKBOX		// recent inputs and outputs, frozen on a
+				// fault and dumped over serial
+#define	BLACKBOX_BYTES	320	// 2.6s of driving at worst, more at rest
+#define	BLACKBOX_PERIOD	40	// ms between samples
+#define	TELEMETRY		// binary frames over serial, 't' toggles
+#define	TELEMETRY_PERIOD 20	// ms between frames
+#define	TELEMETRY_RING	64	// bytes queued for the serial port
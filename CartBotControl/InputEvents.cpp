@@ -0,0 +1,76 @@
+/*
+** CartBot control software
+** Stephen Tarr
+** FRC Team 1425 "Error Code Xero"
+**
+** This code depends on F Malpartida's NewLiquidCrystal library:
+** https://bitbucket.org/fmalpartida/new-liquidcrystal 
+*/
+#include "InputEvents.h"
+
+InputEvents::InputEvents()
+  : state(0)
+{
+    for (int i = 0; i < NUM_INPUTS; i++) {
+	count[i] = 0;
+    }
+}
+
+// 'set' and 'clear' push the input one way or the other; in between,
+// in the band, it holds and the count starts over
+uint8_t InputEvents::Debounce( InputId input, bool set, bool clear,
+			       uint8_t samples )
+{
+    bool on = Is(input);
+
+    if ((on && clear) || (!on && set)) {
+	if (++count[input] >= samples) {
+	    count[input] = 0;
+	    state ^= EVENT(input);
+	    return EVENT(input);
+	}
+    } else {
+	count[input] = 0;
+    }
+    return 0;
+}
+
+uint8_t InputEvents::UpdateBattery( int vbat )
+{
+    return Debounce(INPUT_CHARGE_NEEDED,
+		    vbat < VBAT_MIN, vbat >= VBAT_MIN + VBAT_HYST) |
+	   Debounce(INPUT_LOW_BATTERY,
+		    vbat < VBAT_LOW, vbat >= VBAT_LOW + VBAT_HYST);
+}
+
+uint8_t InputEvents::UpdateEnable( int venbl, int vbat )
+{
+    // a ratio keeps the threshold where it was as the battery runs
+    // down; a fixed margin in counts would not
+    long pct = 100L * venbl;
+
+    return Debounce(INPUT_ENABLED,
+		    pct >= (long) (ENABLE_PCT + ENABLE_HYST_PCT) * vbat,
+		    pct < (long) ENABLE_PCT * vbat, ENABLE_DEBOUNCE);
+}
+
+uint8_t InputEvents::Settle( int vbat, int venbl, int x, int y,
+			     const JoystickCal &cal )
+{
+    uint8_t changed = 0;
+    for (int i = 0; i < EVENT_DEBOUNCE || i < ENABLE_DEBOUNCE; i++) {
+	changed |= UpdateBattery(vbat) | UpdateEnable(venbl, vbat) |
+		   UpdateJoystick(x, y, cal);
+    }
+    return changed;
+}
+
+uint8_t InputEvents::UpdateJoystick( int x, int y, const JoystickCal &cal )
+{
+    int dx = cal.X().Offset(x);
+    int dy = cal.Y().Offset(y);
+
+    return Debounce(INPUT_OFF_CENTER,
+		    dx >= DEADBAND || dy >= DEADBAND,
+		    dx < DEADBAND - JOY_HYST && dy < DEADBAND - JOY_HYST);
+}
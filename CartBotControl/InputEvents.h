@@ -0,0 +1,65 @@
+#pragma once
+/*
+** CartBot control software
+** Stephen Tarr - FRC Team 1425 "Error Code Xero"
+**
+** This code depends on F Malpartida's NewLiquidCrystal library:
+** https://bitbucket.org/fmalpartida/new-liquidcrystal 
+*/
+#include <stdint.h>
+#include "Hardware.h"
+#include "JoystickCal.h"
+
+// boolean inputs derived from the filtered A2D values
+enum InputId {
+    INPUT_CHARGE_NEEDED,	// Vbat below VBAT_MIN
+    INPUT_LOW_BATTERY,		// Vbat below VBAT_LOW
+    INPUT_ENABLED,		// enable button pressed
+    INPUT_OFF_CENTER,		// either joystick axis outside DEADBAND
+    NUM_INPUTS
+};
+
+// event bits: an input changed, or a control period went by
+#define	EVENT(input)	(1 << (input))
+#define	EVENT_TICK	(1 << NUM_INPUTS)
+
+// The inputs, each with a hysteresis band and a debounce.  An input
+// only changes after EVENT_DEBOUNCE samples in a row on the far side of
+// its band, so a reading that sits on a threshold can't make the state
+// machine chatter.  The bands lie on the side away from safety: the
+// battery faults, the enable button releases and the stick leaves
+// center at the thresholds they always had; it's the way back that has
+// to clear the band.
+//
+// Enable is the exception to the sampling rate: it is read every tick,
+// straight from the ADC window, as a ratio to the averaged Vbat, and
+// takes ENABLE_DEBOUNCE ticks - so letting go of the button stops the
+// motors within two ticks, not after the battery average catches up.
+class InputEvents {
+public:
+    InputEvents();
+
+    // each returns the events for the inputs that changed
+    uint8_t UpdateBattery( int vbat );
+    uint8_t UpdateEnable( int venbl, int vbat );
+    uint8_t UpdateJoystick( int x, int y, const JoystickCal &cal );
+
+    // at boot: take the readings as they stand, without the debounce
+    uint8_t Settle( int vbat, int venbl, int x, int y,
+		    const JoystickCal &cal );
+
+    bool Is( InputId input ) const
+    {
+	return (state & EVENT(input)) != 0;
+    }
+
+    // all of them, a bit per input
+    uint8_t Bits() const { return state; }
+
+private:
+    uint8_t Debounce( InputId input, bool set, bool clear,
+		      uint8_t samples = EVENT_DEBOUNCE );
+
+    uint8_t state;		// bit per input
+    uint8_t count[NUM_INPUTS];	// samples in a row asking for a change
+};
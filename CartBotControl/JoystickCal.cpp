@@ -0,0 +1,202 @@
+/*
+** CartBot control software
+** Stephen Tarr
+** FRC Team 1425 "Error Code Xero"
+**
+** This code depends on F Malpartida's NewLiquidCrystal library:
+** https://bitbucket.org/fmalpartida/new-liquidcrystal 
+*/
+#include <stddef.h>
+#include <EEPROM.h>
+#include "JoystickCal.h"
+
+#define	CAL_MAGIC	0xCA1B
+
+// a stop counts as reached when the stick got within 10% of the span
+// the stored calibration allows on that side
+#define	STOP_REACHED(seen, span)	((seen) * 10L >= (span) * 9L)
+
+void JoyAxis::Set( const AxisCal &cal )
+{
+    int band = JOY_DEADBAND_MIN + cal.noise;
+    center = cal.center;
+    lo = cal.center - band;
+    hi = cal.center + band;
+    scaleLo = (JOY_TRAVEL * 256L + (lo - cal.min) / 2) / (lo - cal.min);
+    scaleHi = (JOY_TRAVEL * 256L + (cal.max - hi) / 2) / (cal.max - hi);
+}
+
+JoystickCal::JoystickCal()
+  : calibrated(false),
+    saveIndex(sizeof(Record)),
+    samples(0)
+{
+    for (int i = 0; i < 2; i++) {
+	record.axis[i].min = 0;
+	record.axis[i].center = 512;
+	record.axis[i].max = 1023;
+	record.axis[i].noise = DEADBAND - JOY_DEADBAND_MIN;
+	seenMin[i] = 1023;
+	seenMax[i] = 0;
+    }
+    record.magic = CAL_MAGIC;
+    record.check = Checksum(record);
+    Apply();
+}
+
+uint8_t JoystickCal::Checksum( const Record &r )
+{
+    const uint8_t *p = (const uint8_t *) &r;
+    uint8_t sum = 0;
+    for (uint8_t i = 0; i < offsetof(Record, check); i++) {
+	sum = ((sum << 1) | (sum >> 7)) ^ p[i];
+    }
+    return sum;
+}
+
+// The hands-off test is DEADBAND around the center, so a stick held off
+// center through InitState can pass it.  Keep the center close enough to
+// 512 that a stick at true rest is still inside the motor deadband.
+bool JoystickCal::Plausible( const AxisCal &cal )
+{
+    int band = JOY_DEADBAND_MIN + cal.noise;
+    return abs(cal.center - 512) <= DEADBAND - band &&
+	   cal.noise <= JOY_NOISE_MAX &&
+	   cal.center - band - cal.min >= JOY_TRAVEL / 2 &&
+	   cal.max - (cal.center + band) >= JOY_TRAVEL / 2;
+}
+
+void JoystickCal::Apply()
+{
+    axis[0].Set(record.axis[0]);
+    axis[1].Set(record.axis[1]);
+}
+
+void JoystickCal::Load()
+{
+    Record r;
+    EEPROM.get(CAL_EEPROM_ADDR, r);
+    if (r.magic != CAL_MAGIC || r.check != Checksum(r) ||
+	!Plausible(r.axis[0]) || !Plausible(r.axis[1])) {
+	return;
+    }
+    record = r;
+    calibrated = true;
+    Apply();
+}
+
+void JoystickCal::Save()
+{
+    record.check = Checksum(record);
+    saveIndex = 0;
+}
+
+void JoystickCal::Service()
+{
+    // EEPROM.update() skips bytes that haven't changed, and the one
+    // write it may start runs on while we carry on
+    if (saveIndex < sizeof(Record)) {
+	EEPROM.update(CAL_EEPROM_ADDR + saveIndex,
+		      ((const uint8_t *) &record)[saveIndex]);
+	++saveIndex;
+    }
+}
+
+void JoystickCal::BeginCapture()
+{
+    for (int i = 0; i < 2; i++) {
+	sum[i] = 0;
+	low[i] = 1023;
+	high[i] = 0;
+    }
+    samples = 0;
+}
+
+void JoystickCal::Capture( int x, int y )
+{
+    int v[2] = { x, y };
+    for (int i = 0; i < 2; i++) {
+	sum[i] += v[i];
+	if (v[i] < low[i]) low[i] = v[i];
+	if (v[i] > high[i]) high[i] = v[i];
+    }
+    ++samples;
+}
+
+void JoystickCal::EndCapture()
+{
+    if (samples == 0) {
+	return;
+    }
+
+    Record r = record;
+    for (int i = 0; i < 2; i++) {
+	int center = (sum[i] + samples / 2) / samples;
+	int noise = high[i] - center;
+	if (center - low[i] > noise) {
+	    noise = center - low[i];
+	}
+	if (noise > 255) {
+	    return;
+	}
+
+	// only a small step from the stored center or back to 512, and
+	// never one past the motor deadband: anything else is a hand on
+	// the stick, so keep the old record
+	int prev = record.axis[i].center;
+	int tol = JOY_CENTER_TOL + noise;
+	if (abs(center - prev) > tol && abs(center - 512) > tol) {
+	    return;
+	}
+	if (abs(center - prev) > DEADBAND - (JOY_DEADBAND_MIN + noise)) {
+	    return;
+	}
+	r.axis[i].center = center;
+	r.axis[i].noise = noise;
+	if (!Plausible(r.axis[i])) {
+	    return;
+	}
+    }
+    record = r;
+    calibrated = true;
+    Commit();
+    Apply();
+    Save();
+}
+
+void JoystickCal::Track( int x, int y )
+{
+    if (x < seenMin[0]) seenMin[0] = x;
+    if (x > seenMax[0]) seenMax[0] = x;
+    if (y < seenMin[1]) seenMin[1] = y;
+    if (y > seenMax[1]) seenMax[1] = y;
+}
+
+void JoystickCal::Commit()
+{
+    bool changed = false;
+    for (int i = 0; i < 2; i++) {
+	AxisCal cal = record.axis[i];
+	int band = JOY_DEADBAND_MIN + cal.noise;
+	int lo = cal.center - band;
+	int hi = cal.center + band;
+
+	if (seenMin[i] != cal.min &&
+	    STOP_REACHED(lo - seenMin[i], lo - cal.min)) {
+	    cal.min = seenMin[i];
+	}
+	if (seenMax[i] != cal.max &&
+	    STOP_REACHED(seenMax[i] - hi, cal.max - hi)) {
+	    cal.max = seenMax[i];
+	}
+	if (Plausible(cal) && (cal.min != record.axis[i].min ||
+			       cal.max != record.axis[i].max)) {
+	    record.axis[i] = cal;
+	    changed = true;
+	}
+    }
+    if (changed) {
+	Apply();
+	Save();
+    }
+}
@@ -0,0 +1,109 @@
+#pragma once
+/*
+** CartBot control software
+** Stephen Tarr - FRC Team 1425 "Error Code Xero"
+**
+** This code depends on F Malpartida's NewLiquidCrystal library:
+** https://bitbucket.org/fmalpartida/new-liquidcrystal 
+*/
+#include <Arduino.h>
+#include "Hardware.h"
+
+// full stick deflection, in the units the motor mixing has always used
+// (A2D counts past the uncalibrated deadband)
+#define	JOY_TRAVEL	(1023 - (512 + DEADBAND))
+
+// calibration of one axis as stored in EEPROM, A2D units
+struct AxisCal {
+    int16_t min;		// stick against its stops
+    int16_t center;		// at rest
+    int16_t max;
+    uint8_t noise;		// peak deviation from center at rest
+};
+
+// One axis with everything the per-tick code needs worked out in advance:
+// the deadband edges and Q8 scales that stretch what is left of the
+// travel on either side over +/-JOY_TRAVEL.
+class JoyAxis {
+public:
+    void Set( const AxisCal &cal );
+
+    // signed deflection beyond the deadband; 0 inside it
+    int Deflection( int raw ) const
+    {
+	if (raw > hi) {
+	    return ((long) (raw - hi) * scaleHi) >> 8;
+	}
+	if (raw < lo) {
+	    return -(int) (((long) (lo - raw) * scaleLo) >> 8);
+	}
+	return 0;
+    }
+
+    // distance from the measured center; hands off is within DEADBAND
+    int Offset( int raw ) const
+    {
+	return abs(raw - center);
+    }
+
+private:
+    int center;
+    int lo, hi;			// deadband edges
+    unsigned int scaleLo, scaleHi;
+};
+
+// Joystick calibration.  InitState measures the center and noise of each
+// axis while it waits for the controls to be released; the stops are
+// learned from driving.  The result is kept in EEPROM with a magic number
+// and checksum and written back a byte per control period, so saving
+// never stalls the loop on the 3.4ms EEPROM write time.
+class JoystickCal {
+public:
+    JoystickCal();
+
+    // read the stored calibration, or fall back to the uncalibrated
+    // defaults (center 512, deadband DEADBAND)
+    void Load();
+
+    // center capture, while InitState holds the controls released
+    void BeginCapture();
+    void Capture( int x, int y );
+    void EndCapture();
+
+    // every control period: note the stops, write pending EEPROM bytes
+    void Track( int x, int y );
+    void Service();
+
+    // adopt the stops seen while driving if they were clearly reached
+    void Commit();
+
+    const JoyAxis &X() const { return axis[0]; }
+    const JoyAxis &Y() const { return axis[1]; }
+    const AxisCal &Cal( int i ) const { return record.axis[i]; }
+    bool IsCalibrated() const { return calibrated; }
+
+private:
+    struct Record {
+	uint16_t magic;
+	AxisCal axis[2];
+	uint8_t check;
+    };
+
+    static uint8_t Checksum( const Record &r );
+    static bool Plausible( const AxisCal &cal );
+    void Apply();
+    void Save();
+
+    Record record;
+    JoyAxis axis[2];
+    bool calibrated;		// record came from a capture
+    uint8_t saveIndex;		// next byte to write, sizeof(Record) if none
+
+    // capture in progress
+    long sum[2];
+    int low[2], high[2];
+    unsigned int samples;
+
+    // stops reached since power-on
+    int seenMin[2], seenMax[2];
+};
@@ -0,0 +1,89 @@
+#pragma once
+/*
+** CartBot control software
+** Stephen Tarr - FRC Team 1425 "Error Code Xero"
+**
+** This code depends on F Malpartida's NewLiquidCrystal library:
+** https://bitbucket.org/fmalpartida/new-liquidcrystal 
+*/
+#include "Hardware.h"
+#include "AdcSampler.h"
+
+// log2 of a power of two, at compile time
+constexpr int Log2( long n )
+{
+    return n > 1 ? 1 + Log2(n >> 1) : 0;
+}
+
+// Joystick input stage, updated once per control period.  The sampler's
+// window of ADC_OVERSAMPLE conversions is decimated to FRACTION_BITS
+// below the A2D unit (4^n conversions buy n bits), then smoothed by a
+// one-pole low-pass kept with JOY_FILTER_SHIFT guard bits so it rounds
+// instead of creeping.  Both stages are short on purpose: the boxcar
+// spans less than a control period and the pole sits at 1/2, so the
+// noise at the DEADBAND edge is gone but the stick still feels direct.
+class JoystickFilter {
+public:
+    enum {
+	FRACTION_BITS = Log2(ADC_OVERSAMPLE) / 2,
+	STATE_BITS = FRACTION_BITS + JOY_FILTER_SHIFT
+    };
+
+    // group delay added to the stick: half the oversampling window, plus
+    // 2^shift - 1 control periods for the low-pass
+    static constexpr long LATENCY_US =
+	(ADC_OVERSAMPLE - 1) * ADC_ROUND_US / 2 +
+	((1L << JOY_FILTER_SHIFT) - 1) * CONTROL_PERIOD * 1000L;
+    static constexpr int LATENCY_TICKS =
+	(LATENCY_US + LOOP_TIME * 1000L - 1) / (LOOP_TIME * 1000L);
+
+    JoystickFilter()
+      : primed(false)
+    {
+	state[0] = state[1] = 0;
+    }
+
+    void Update( const AdcSnapshot &adc )
+    {
+	if (adc.filled == 0) {
+	    return;		// nothing converted yet
+	}
+	int x = Decimate(adc.sum[ADC_JOYX]);
+	int y = Decimate(adc.sum[ADC_JOYY]);
+	if (!primed) {
+	    state[0] = x << JOY_FILTER_SHIFT;
+	    state[1] = y << JOY_FILTER_SHIFT;
+	    primed = true;
+	}
+	state[0] += x - (state[0] >> JOY_FILTER_SHIFT);
+	state[1] += y - (state[1] >> JOY_FILTER_SHIFT);
+    }
+
+    // filtered position in A2D units (0..1023)
+    int X() const
+    {
+	return Round(state[0], STATE_BITS);
+    }
+
+    int Y() const
+    {
+	return Round(state[1], STATE_BITS);
+    }
+
+private:
+    static_assert(10 + STATE_BITS <= 15,
+		  "joystick filter state must fit in an int");
+
+    static int Round( int value, int bits )
+    {
+	return (value + ((1 << bits) >> 1)) >> bits;
+    }
+
+    static int Decimate( uint16_t sum )
+    {
+	return Round(sum, Log2(ADC_OVERSAMPLE) - FRACTION_BITS);
+    }
+
+    bool primed;
+    int state[2];		// x, y with STATE_BITS fraction bits
+};
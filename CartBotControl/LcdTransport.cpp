@@ -0,0 +1,142 @@
+/*
+** CartBot control software
+** Stephen Tarr
+** FRC Team 1425 "Error Code Xero"
+**
+** This code depends on F Malpartida's NewLiquidCrystal library:
+** https://bitbucket.org/fmalpartida/new-liquidcrystal 
+*/
+#include "Display.h"
+
+// expander bytes per LCD byte: two nibbles, each with E high then low
+#define	STATES_PER_BYTE	4
+
+// the stock driver's traffic per LCD byte: 4 transmissions of address
+// plus one expander state
+#define	STOCK_BUS_BYTES	(STATES_PER_BYTE * 2)
+
+// bus time of a bit, of a transmission's start, address and stop plus
+// the TWI driver's setup, and of one LCD byte's expander states
+#ifdef LCD_I2C_FAST
+#define	I2C_BIT_NS	2500
+#else
+#define	I2C_BIT_NS	10000
+#endif
+#define	I2C_SEND_US	(12 + 20 * I2C_BIT_NS / 1000)
+#define	LCD_STATES_US	(STATES_PER_BYTE * 9 * I2C_BIT_NS / 1000)
+#define	STOCK_BYTE_US	(STATES_PER_BYTE * (I2C_SEND_US + 9 * I2C_BIT_NS / 1000))
+
+LcdTransport::LcdTransport( LiquidCrystal_I2C &lcd )
+  : lcd(lcd), length(0)
+{
+    ;
+}
+
+void LcdTransport::Begin()
+{
+#ifdef LCD_I2C_FAST
+    Wire.setClock(400000);
+#endif
+}
+
+#ifdef LCD_BATCHED
+
+void LcdTransport::Queue( uint8_t value, uint8_t rs )
+{
+    // the backlight stays on, as lcd.backlight() left it
+    uint8_t ctl = rs | (1 << BACKLIGHT_PIN);
+    uint8_t nibble[2] = { (uint8_t) (value >> 4), (uint8_t) (value & 0x0F) };
+
+    for (uint8_t n = 0; n < 2; n++) {
+	uint8_t state = ctl;
+	if (nibble[n] & 0x01) state |= (1 << D4_PIN);
+	if (nibble[n] & 0x02) state |= (1 << D5_PIN);
+	if (nibble[n] & 0x04) state |= (1 << D6_PIN);
+	if (nibble[n] & 0x08) state |= (1 << D7_PIN);
+	buffer[length++] = state | (1 << EN_PIN);
+	buffer[length++] = state;
+    }
+}
+
+void LcdTransport::Cursor( uint8_t col, uint8_t row )
+{
+    static const uint8_t rowOffset[LCD_ROWS] = { 0x00, 0x40, 0x14, 0x54 };
+    Queue(LCD_SETDDRAMADDR | (col + rowOffset[row]), 0);
+}
+
+void LcdTransport::CharAddress( uint8_t address )
+{
+    Queue(LCD_SETCGRAMADDR | address, 0);
+}
+
+void LcdTransport::Data( uint8_t value )
+{
+    Queue(value, 1 << RS_PIN);
+}
+
+bool LcdTransport::Room() const
+{
+    return length + STATES_PER_BYTE <= BUFFER_LENGTH;
+}
+
+uint8_t LcdTransport::Afford( unsigned long micros ) const
+{
+    uint8_t room = (BUFFER_LENGTH - length) / STATES_PER_BYTE;
+    unsigned long fit = micros > I2C_SEND_US ?
+	(micros - I2C_SEND_US) / LCD_STATES_US : 0;
+    return fit < room ? fit : room;
+}
+
+uint8_t LcdTransport::Send()
+{
+    if (!length) {
+	return 0;
+    }
+    Wire.beginTransmission(I2C_ADDR);
+    Wire.write(buffer, length);
+    Wire.endTransmission();
+
+    uint8_t sent = 1 + length;
+    length = 0;
+    return sent;
+}
+
+#else // one LCD byte at a time through the library
+
+void LcdTransport::Cursor( uint8_t col, uint8_t row )
+{
+    lcd.setCursor(col, row);
+    ++length;
+}
+
+void LcdTransport::CharAddress( uint8_t address )
+{
+    lcd.command(LCD_SETCGRAMADDR | address);
+    ++length;
+}
+
+void LcdTransport::Data( uint8_t value )
+{
+    lcd.write(value);
+    ++length;
+}
+
+bool LcdTransport::Room() const
+{
+    return length == 0;
+}
+
+// the library writes as it goes, a byte at a time
+uint8_t LcdTransport::Afford( unsigned long micros ) const
+{
+    return micros >= STOCK_BYTE_US;
+}
+
+uint8_t LcdTransport::Send()
+{
+    uint8_t sent = length * STOCK_BUS_BYTES;
+    length = 0;
+    return sent;
+}
+
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+/*
+** CartBot control software
+** Stephen Tarr - FRC Team 1425 "Error Code Xero"
+**
+** This code depends on F Malpartida's NewLiquidCrystal library:
+** https://bitbucket.org/fmalpartida/new-liquidcrystal 
+*/
+#include <Wire.h>
+#include <LCD.h>
+#include <LiquidCrystal_I2C.h>
+
+// Runtime writes to the LCD: cursor moves and characters.  LiquidCrystal_I2C
+// sends every expander state in a Wire transmission of its own, four per
+// LCD byte.  With LCD_BATCHED defined the transport builds the nibble and
+// enable-strobe states itself and packs them into one transmission of up
+// to BUFFER_LENGTH bytes, eight LCD bytes per transmission.  No delays are
+// needed: two expander bytes on the bus (45us even at 400 kHz) outlast the
+// 37us an HD44780 takes to execute a write.  Initialization, with its long
+// delays, stays with the library.
+class LcdTransport {
+public:
+    LcdTransport( LiquidCrystal_I2C &lcd );
+
+    // after lcd.begin(), which puts the bus back to 100 kHz
+    void Begin();
+
+    // queue a cursor move, a move to a CGRAM address (Data() then writes
+    // glyph rows from there) or a character; only while Room()
+    void Cursor( uint8_t col, uint8_t row );
+    void CharAddress( uint8_t address );
+    void Data( uint8_t value );
+    bool Room() const;
+
+    // LCD bytes that can be queued and sent in 'micros' of bus time, as
+    // many as Room() allows
+    uint8_t Afford( unsigned long micros ) const;
+
+    // end the transmission being built; returns the bus bytes sent
+    uint8_t Send();
+
+private:
+    void Queue( uint8_t value, uint8_t rs );
+
+    LiquidCrystal_I2C &lcd;
+    uint8_t length;		// expander bytes (or LCD bytes) queued
+#ifdef LCD_BATCHED
+    uint8_t buffer[BUFFER_LENGTH];
+#endif
+};
@@ -0,0 +1,128 @@
+/*
+** CartBot control software
+** Stephen Tarr
+** FRC Team 1425 "Error Code Xero"
+**
+** This code depends on F Malpartida's NewLiquidCrystal library:
+** https://bitbucket.org/fmalpartida/new-liquidcrystal 
+*/
+#include "LoopStats.h"
+
+static const char phaseName[NUM_PHASES][14] PROGMEM = {
+    "ReadEnable   ",
+    "ReadJoystick ",
+    "ReadBattery  ",
+    "UpdateState  ",
+    "UpdateOutputs",
+    "UpdateDisplay",
+    "FlushDisplay ",
+    "Telemetry    ",
+    "tick         ",
+};
+
+void PhaseStats::Reset()
+{
+    minTime = 0xFFFF;
+    maxTime = 0;
+    totalTime = 0;
+    count = 0;
+    for (int i = 0; i < STATS_BUCKETS; i++) {
+	histogram[i] = 0;
+    }
+}
+
+void PhaseStats::Record( unsigned long us )
+{
+    uint16_t t = us > 0xFFFF ? 0xFFFF : us;
+    if (t < minTime) minTime = t;
+    if (t > maxTime) maxTime = t;
+
+    // 0xFFFF samples of at most 0xFFFF can't overflow the total
+    if (count == 0xFFFF) {
+	totalTime /= 2;
+	count /= 2;
+    }
+    totalTime += t;
+    ++count;
+
+    uint8_t bucket = 0;
+    for (t >>= STATS_SHIFT; t && bucket < STATS_BUCKETS - 1; t >>= 1) {
+	++bucket;
+    }
+    if (histogram[bucket] == 0xFF) {
+	// rounding up keeps a bucket that has ever been hit nonzero
+	for (uint8_t i = 0; i < STATS_BUCKETS; i++) {
+	    histogram[i] = (histogram[i] + 1) / 2;
+	}
+    }
+    ++histogram[bucket];
+}
+
+unsigned int PhaseStats::Mean() const
+{
+    return count ? (totalTime + count / 2) / count : 0;
+}
+
+////////////////////////////////////////////////
+
+void PrintField( Print &out, unsigned long n, int width )
+{
+    for (unsigned long limit = 10; --width > 0; limit *= 10) {
+	if (n < limit) out.print(' ');
+    }
+    out.print(n);
+}
+
+void PrintP( Print &out, PGM_P s )
+{
+    char c;
+    while ((c = pgm_read_byte(s++)) != '\0') {
+	out.print(c);
+    }
+}
+
+LoopStats::LoopStats()
+{
+    Reset();
+}
+
+void LoopStats::Reset()
+{
+    for (int i = 0; i < NUM_PHASES; i++) {
+	phase[i].Reset();
+    }
+    ticks = 0;
+    overruns = 0;
+    overBudget = 0;
+}
+
+void LoopStats::Print( ::Print &out ) const
+{
+    PrintP(out, PSTR("phase (us)       min   max  mean  histogram <"));
+    for (int b = 0; b < STATS_BUCKETS - 1; b++) {
+	out.print(1UL << (b + STATS_SHIFT));
+	PrintP(out, b < STATS_BUCKETS - 2 ? PSTR(" <") : PSTR(" >="));
+    }
+    out.println(1UL << (STATS_BUCKETS - 2 + STATS_SHIFT));
+
+    for (int i = 0; i < NUM_PHASES; i++) {
+	const PhaseStats &p = phase[i];
+	PrintP(out, phaseName[i]);
+	PrintField(out, p.count ? p.minTime : 0, 6);
+	PrintField(out, p.maxTime, 6);
+	PrintField(out, p.Mean(), 6);
+	out.print(' ');
+	for (int b = 0; b < STATS_BUCKETS; b++) {
+	    out.print(' ');
+	    out.print(p.histogram[b]);
+	}
+	out.println();
+    }
+
+    PrintP(out, PSTR("ticks "));
+    out.print(ticks);
+    PrintP(out, PSTR(" over budget "));
+    out.print(overBudget);
+    PrintP(out, PSTR(" overruns "));
+    out.println(overruns);
+}
@@ -0,0 +1,104 @@
+#pragma once
+/*
+** CartBot control software
+** Stephen Tarr - FRC Team 1425 "Error Code Xero"
+**
+** This code depends on F Malpartida's NewLiquidCrystal library:
+** https://bitbucket.org/fmalpartida/new-liquidcrystal 
+*/
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+#include "Hardware.h"
+
+// phases of the CartBot tasks, plus the whole tick
+enum LoopPhase {
+    PHASE_READ_ENABLE,
+    PHASE_READ_JOYSTICK,
+    PHASE_READ_BATTERY,
+    PHASE_UPDATE_STATE,
+    PHASE_UPDATE_OUTPUTS,
+    PHASE_UPDATE_DISPLAY,
+    PHASE_FLUSH_DISPLAY,
+    PHASE_TELEMETRY,
+    PHASE_TICK,
+    NUM_PHASES
+};
+
+// log2 histogram buckets: <16us, <32us, <64us ... >=4096us
+#define	STATS_BUCKETS	10
+#define	STATS_SHIFT	4
+
+// right-justify n in a field of the given width
+void PrintField( Print &out, unsigned long n, int width );
+
+// print a string kept in flash
+void PrintP( Print &out, PGM_P s );
+
+// 20 bytes a phase: times saturate at 65535us, and the count and the
+// histogram are halved as they fill, so they weigh the recent past
+// rather than wrapping; a histogram bucket once hit stays at least 1
+class PhaseStats {
+public:
+    void Reset();
+    void Record( unsigned long us );
+    unsigned int Mean() const;
+
+    uint16_t minTime;		// in microseconds
+    uint16_t maxTime;
+    uint32_t totalTime;
+    uint16_t count;
+    uint8_t histogram[STATS_BUCKETS];
+};
+
+class LoopStats {
+public:
+    LoopStats();
+
+    void Reset();
+
+    // Start() and Lap() compile away when LOOP_STATS is not defined;
+    // Lap() records the time since 'since' and returns the current time
+    unsigned long Start();
+    unsigned long Lap( LoopPhase phase, unsigned long since );
+
+    // called by the main loop with how late a deadline was serviced
+    void Late( unsigned long ms );
+
+    void Print( ::Print &out ) const;
+
+    PhaseStats phase[NUM_PHASES];
+    unsigned long ticks;	// since Reset(), unlike phase[].count
+    unsigned long overruns;	// deadline serviced more than LOOP_TIME late
+    unsigned long overBudget;	// ticks that took longer than LOOP_TIME
+};
+
+#ifdef LOOP_STATS
+inline unsigned long LoopStats::Start()
+{
+    return micros();
+}
+
+inline unsigned long LoopStats::Lap( LoopPhase p, unsigned long since )
+{
+    unsigned long now = micros();
+    phase[p].Record(now - since);
+    if (p == PHASE_TICK) {
+	++ticks;
+	if (now - since > LOOP_TIME * 1000UL) {
+	    ++overBudget;
+	}
+    }
+    return now;
+}
+
+inline void LoopStats::Late( unsigned long ms )
+{
+    if (ms > LOOP_TIME) {
+	++overruns;
+    }
+}
+#else
+inline unsigned long LoopStats::Start() { return 0; }
+inline unsigned long LoopStats::Lap( LoopPhase, unsigned long ) { return 0; }
+inline void LoopStats::Late( unsigned long ) { }
+#endif
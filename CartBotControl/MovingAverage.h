@@ -0,0 +1,64 @@
+#pragma once
+/*
+** CartBot control software
+** Stephen Tarr - FRC Team 1425 "Error Code Xero"
+**
+** This code depends on F Malpartida's NewLiquidCrystal library:
+** https://bitbucket.org/fmalpartida/new-liquidcrystal 
+*/
+#include <stdint.h>
+
+// Select<C, A, B>::Type is A when C holds, else B
+template <bool C, class A, class B> struct Select { typedef B Type; };
+template <class A, class B> struct Select<true, A, B> { typedef A Type; };
+
+// Moving average of the last N samples on each of CHANNELS channels,
+// kept as a running sum: each Add() costs the same whatever N is, and
+// Average() gives exactly the rounded mean of the window.
+template <int N, int CHANNELS>
+class MovingAverage {
+public:
+    // the narrowest type that holds a window of 10-bit A2D samples;
+    // 16-bit arithmetic is much cheaper on the AVR
+    typedef typename Select<(N * 1023L <= 0xFFFFL),
+			    unsigned int, unsigned long>::Type Sum;
+
+    explicit MovingAverage( int initial )
+    {
+	Fill(initial);
+    }
+
+    // set every sample in the window (all channels) to 'value'
+    void Fill( int value )
+    {
+	for (int c = 0; c < CHANNELS; c++) {
+	    for (int i = 0; i < N; i++) {
+		samples[i][c] = value;
+	    }
+	    sum[c] = (Sum) value * N;
+	}
+	index = 0;
+    }
+
+    // replace the oldest sample on every channel
+    void Add( const int *values )
+    {
+	for (int c = 0; c < CHANNELS; c++) {
+	    sum[c] += values[c] - samples[index][c];
+	    samples[index][c] = values[c];
+	}
+	if (++index >= N) {
+	    index = 0;
+	}
+    }
+
+    int Average( int channel ) const
+    {
+	return (sum[channel] + N/2) / N;
+    }
+
+private:
+    int samples[N][CHANNELS];
+    Sum sum[CHANNELS];
+    typename Select<(N < 256), uint8_t, unsigned int>::Type index;
+};
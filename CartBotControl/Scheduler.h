@@ -0,0 +1,46 @@
+#pragma once
+/*
+** CartBot control software
+** Stephen Tarr - FRC Team 1425 "Error Code Xero"
+**
+** This code depends on F Malpartida's NewLiquidCrystal library:
+** https://bitbucket.org/fmalpartida/new-liquidcrystal 
+*/
+#include <stdint.h>
+
+// Static multi-rate scheduler.  Each task is a member function of the
+// owner with its own period and phase, both in main loop ticks; Tick()
+// is called once per LOOP_TIME and runs whichever tasks are due.  Give
+// slow tasks phases that keep them off the fast task's ticks.
+template <class T, int N>
+class Scheduler {
+public:
+    struct Task {
+	void (T::*run)();
+	uint8_t period;		// ticks between runs
+	uint8_t phase;		// tick of the first run
+    };
+
+    Scheduler( const Task *table )
+      : tasks(table)
+    {
+	for (int i = 0; i < N; i++) {
+	    countdown[i] = tasks[i].phase;
+	}
+    }
+
+    void Tick( T &owner )
+    {
+	for (int i = 0; i < N; i++) {
+	    if (countdown[i] == 0) {
+		countdown[i] = tasks[i].period;
+		(owner.*tasks[i].run)();
+	    }
+	    --countdown[i];
+	}
+    }
+
+private:
+    const Task *tasks;
+    uint8_t countdown[N];
+};
@@ -8,159 +8,178 @@
 */
 #include "CartBot.h"
 #include "Hardware.h"
-
-#define	POWER_ON_TIME	5000	// milliseconds
+#include "Format.h"
+
+#ifdef FAST_BOOT
+#define	POWER_ON_TIME	1000	// milliseconds
+#define	POWER_ON_LABEL	"1 second"
+#define	INIT_TIME	500
+#define	INIT_LABEL	"0.5 seconds"
+#else
+#define	POWER_ON_TIME	5000
+#define	POWER_ON_LABEL	"5 seconds"
 #define	INIT_TIME	2000
+#define	INIT_LABEL	"2 seconds"
+#endif
 
 #define	DEBUG_MOTORS
 
-State::State()
-{
-    ResetTimer();
-}
+#define	DEBOUNCE_TICKS	(DEBOUNCE_TIME / CONTROL_PERIOD)
 
-State::~State()
-{
-    ;
-}
-
-void State::ResetTimer()
-{
-    startTime = millis();
-}
+////////////////////////////////////////
+//
+// State diagram (see "State Diagram.vsdx").  Transitions out of a state
+// are tried in order, when one of their trigger events comes in; the
+// first whose guard holds is taken at the end of the tick.  'cartsim -g' prints this as a Graphviz graph.
+//
+////////////////////////////////////////
 
-unsigned long State::TimeInState()
-{
-    unsigned long now = millis();
-    return (long)(now - startTime);
+static const char powerOnName[] PROGMEM = "POWER ON";
+static const char initName[] PROGMEM = "INIT";
+static const char disabledName[] PROGMEM = "DISABLED";
+static const char enabledName[] PROGMEM = "ENABLED";
+static const char controlFaultName[] PROGMEM = "CONTROL FAULT";
+static const char batteryFaultName[] PROGMEM = "BATTERY FAULT";
+static const char testName[] PROGMEM = "TEST";
+
+static const char testPressed[] PROGMEM = "test button pressed";
+static const char powerOnDone[] PROGMEM = POWER_ON_LABEL;
+static const char chargeNeeded[] PROGMEM = "battery <= 10.5V";
+static const char controlActive[] PROGMEM = "enabled or joystick not centered";
+static const char initDone[] PROGMEM = INIT_LABEL;
+static const char offCenter[] PROGMEM = "joystick not centered";
+static const char enable[] PROGMEM = "enable";
+static const char disable[] PROGMEM = "disable";
+static const char controlReleased[] PROGMEM = "disabled and joystick centered";
+
+#define	CHARGE		EVENT(INPUT_CHARGE_NEEDED)
+#define	ENABLED		EVENT(INPUT_ENABLED)
+#define	OFF_CENTER	EVENT(INPUT_OFF_CENTER)
+#define	CONTROLS	(ENABLED | OFF_CENTER)
+
+CartBot::Machine CartBot::BuildMachine()
+{
+    static constexpr Machine::State states[NUM_STATES] PROGMEM = {
+	// name, enter, exit, update, outputs, display
+	{ powerOnName, &CartBot::EnterPowerOn, NULL, NULL, NULL, NULL },
+	{ initName, &CartBot::EnterInit, NULL, &CartBot::UpdateInit,
+	  NULL, &CartBot::ShowBatteryStatus },
+	{ disabledName, &CartBot::EnterDisabled, NULL, NULL,
+	  NULL, &CartBot::ShowBatteryStatus },
+	{ enabledName, &CartBot::EnterEnabled, &CartBot::DisableMotors, NULL,
+	  &CartBot::UpdateOutputsEnabled, &CartBot::UpdateDisplayEnabled },
+	{ controlFaultName, &CartBot::EnterControlFault, NULL, NULL,
+	  &CartBot::UpdateOutputsControlFault, NULL },
+	{ batteryFaultName, &CartBot::EnterBatteryFault, NULL, NULL,
+	  NULL, NULL },
+	{ testName, &CartBot::EnterTest, &CartBot::DisableMotors,
+	  &CartBot::UpdateTest, &CartBot::UpdateOutputsTest,
+	  &CartBot::UpdateDisplayTest },
+    };
+
+    static constexpr Machine::Transition transitions[] PROGMEM = {
+	// from, to, trigger, guard, action, label
+	{ STATE_POWER_ON, STATE_TEST, EVENT_TICK,
+	  &CartBot::IsTestPressed, NULL, testPressed },
+	{ STATE_POWER_ON, STATE_INIT, EVENT_TICK,
+	  &CartBot::IsPowerOnDone, NULL, powerOnDone },
+
+	{ STATE_INIT, STATE_BATTERY_FAULT, CHARGE,
+	  &CartBot::IsChargeNeeded, NULL, chargeNeeded },
+	{ STATE_INIT, STATE_CONTROL_FAULT, CONTROLS,
+	  &CartBot::IsControlActive, NULL, controlActive },
+	{ STATE_INIT, STATE_DISABLED, EVENT_TICK,
+	  &CartBot::IsInitDone, &CartBot::EndInit, initDone },
+
+	{ STATE_DISABLED, STATE_BATTERY_FAULT, CHARGE,
+	  &CartBot::IsChargeNeeded, NULL, chargeNeeded },
+	{ STATE_DISABLED, STATE_CONTROL_FAULT, OFF_CENTER,
+	  &CartBot::IsJoystickOffCenter, NULL, offCenter },
+	{ STATE_DISABLED, STATE_ENABLED, ENABLED,
+	  &CartBot::IsEnabled, NULL, enable },
+
+	{ STATE_ENABLED, STATE_BATTERY_FAULT, CHARGE,
+	  &CartBot::IsChargeNeeded, NULL, chargeNeeded },
+	{ STATE_ENABLED, STATE_DISABLED, ENABLED,
+	  &CartBot::IsDisabled, NULL, disable },
+
+	{ STATE_CONTROL_FAULT, STATE_BATTERY_FAULT, CHARGE,
+	  &CartBot::IsChargeNeeded, NULL, chargeNeeded },
+	{ STATE_CONTROL_FAULT, STATE_INIT, CONTROLS,
+	  &CartBot::IsControlReleased, NULL, controlReleased },
+    };
+
+    static_assert(Machine::Valid(transitions), "bad state transition table");
+
+    return Machine(states, transitions);
 }
 
 ////////////////////////////////////////
 //
 // PowerOn:
 // - display splash screen
-// - wait 5 seconds
+// - wait POWER_ON_TIME
 //
 ////////////////////////////////////////
 
-PowerOnState::PowerOnState()
-{
-    ;
-}
-
-PowerOnState::~PowerOnState()
+void CartBot::EnterPowerOn()
 {
-    ;
-}
-
-void PowerOnState::EnterState()
-{
-#ifdef SERIAL_DEBUG
-    Serial.println("PowerOnState");
-#endif
-    CartBot::GetInstance().DisableMotors();
-    CartBot::GetDisplay().Print(
-	"WILSONVILLE ROBOTICS",
-	"   FRC TEAM 1425    ",
-	"  ERROR CODE XERO   "
+    DisableMotors();
+    display.Print(
+	FLASH_ROW("WILSONVILLE ROBOTICS"),
+	FLASH_ROW("   FRC TEAM 1425    "),
+	FLASH_ROW("  ERROR CODE XERO   ")
     );
 }
 
-void PowerOnState::UpdateState()
+bool CartBot::IsTestPressed() const
 {
-    if (!digitalRead(TEST_PIN))
-    {
-#ifdef SERIAL_DEBUG
-	Serial.println("PowerOnState -> TestState");
-#endif
-	CartBot::GetInstance().ChangeState(&CartBot::testState);
-    }
-
-    if (TimeInState() > POWER_ON_TIME)
-    {
-#ifdef SERIAL_DEBUG
-	Serial.println("PowerOnState -> InitState");
-#endif
-	CartBot::GetInstance().ChangeState(&CartBot::initState);
-    }
+    return !digitalRead(TEST_PIN);
 }
 
-void PowerOnState::UpdateOutputs()
+bool CartBot::IsPowerOnDone() const
 {
-    ;
-}
-
-void PowerOnState::UpdateDisplay()
-{
-    ;
+    return machine.TimeInState() > POWER_ON_TIME;
 }
 
 ////////////////////////////////////////
 //
 // Init:
-// - wait for 3 seconds with all controls inactive
+// - wait for INIT_TIME with all controls inactive
 // - if enable is pressed or joystick isn't centered,
 //	go to ControlFault state
 //
 ////////////////////////////////////////
 
-InitState::InitState()
+void CartBot::EnterInit()
 {
-    ;
+    joystickCal.BeginCapture();
+    display.Print(
+	FLASH_ROW(" CHECKING CONTROLS  "),
+	FLASH_ROW("     please wait    "),
+	FLASH_ROW("                    ")
+    );
 }
 
-InitState::~InitState()
+void CartBot::UpdateInit()
 {
-    ;
+    joystickCal.Capture(joyx, joyy);
 }
 
-void InitState::EnterState()
+void CartBot::EndInit()
 {
-#ifdef SERIAL_DEBUG
-    Serial.println("InitState");
-#endif
-    CartBot::GetInstance().DisableMotors();
-    CartBot::GetDisplay().Print(
-	" CHECKING CONTROLS  ",
-	"     please wait    ",
-	"                    "
-    );
+    // controls were hands-off throughout: that's the neutral point
+    joystickCal.EndCapture();
 }
 
-void InitState::UpdateState()
+bool CartBot::IsControlActive() const
 {
-    if (CartBot::GetInstance().IsChargeNeeded())
-    {
-#ifdef SERIAL_DEBUG
-	Serial.println("InitState -> BatteryFaultState");
-#endif
-	CartBot::GetInstance().ChangeState(&CartBot::batteryFaultState);
-    }
-    else if (CartBot::GetInstance().IsEnabled() ||
-	     ! CartBot::GetInstance().IsJoystickCentered())
-    {
-#ifdef SERIAL_DEBUG
-	Serial.println("InitState -> ControlFaultState");
-#endif
-	CartBot::GetInstance().ChangeState(&CartBot::controlFaultState);
-    }
-    else if (TimeInState() > INIT_TIME)
-    {
-#ifdef SERIAL_DEBUG
-	Serial.println("InitState -> DisabledState");
-#endif
-	CartBot::GetInstance().ChangeState(&CartBot::disabledState);
-    }
+    return IsEnabled() || !IsJoystickCentered();
 }
 
-void InitState::UpdateOutputs()
+bool CartBot::IsInitDone() const
 {
-    ;
-}
-
-void InitState::UpdateDisplay()
-{
-    CartBot::GetInstance().ShowBatteryStatus();
+    return machine.TimeInState() > INIT_TIME;
 }
 
 ////////////////////////////////////////
@@ -171,63 +190,20 @@ void InitState::UpdateDisplay()
 //
 ////////////////////////////////////////
 
-DisabledState::DisabledState()
+void CartBot::EnterDisabled()
 {
-    ;
-}
+    joystickCal.Commit();
 
-DisabledState::~DisabledState()
-{
-    ;
-}
-
-void DisabledState::EnterState()
-{
-#ifdef SERIAL_DEBUG
-    Serial.println("DisabledState");
-#endif
-    CartBot::GetInstance().DisableMotors();
-
-    CartBot::GetDisplay().Print(
-	"       READY        ",
-	"push button to drive",
-	"                    "
+    display.Print(
+	FLASH_ROW("       READY        "),
+	FLASH_ROW("push button to drive"),
+	FLASH_ROW("                    ")
     );
 }
 
-void DisabledState::UpdateState()
+bool CartBot::IsJoystickOffCenter() const
 {
-    if (CartBot::GetInstance().IsChargeNeeded())
-    {
-#ifdef SERIAL_DEBUG
-	Serial.println("DisabledState -> BatteryFaultState");
-#endif
-	CartBot::GetInstance().ChangeState(&CartBot::batteryFaultState);
-    }
-    else if (!CartBot::GetInstance().IsJoystickCentered())
-    {
-#ifdef SERIAL_DEBUG
-	Serial.println("DisabledState -> ControlFaultState");
-#endif
-	CartBot::GetInstance().ChangeState(&CartBot::controlFaultState);
-    }
-    else if (CartBot::GetInstance().IsEnabled())
-    {
-#ifdef SERIAL_DEBUG
-	Serial.println("DisabledState -> EnabledState");
-#endif
-	CartBot::GetInstance().ChangeState(&CartBot::enabledState);
-    }
-}
-
-void DisabledState::UpdateOutputs()
-{
-    ;
-}
-
-void DisabledState::UpdateDisplay()
-{
-    CartBot::GetInstance().ShowBatteryStatus();
+    return !IsJoystickCentered();
 }
 
 ////////////////////////////////////////
@@ -238,102 +214,69 @@ void DisabledState::UpdateDisplay()
 //
 ////////////////////////////////////////
 
-EnabledState::EnabledState()
-{
-    ;
-}
-
-EnabledState::~EnabledState()
+void CartBot::EnterEnabled()
 {
-    ;
-}
-
-void EnabledState::EnterState()
-{
-#ifdef SERIAL_DEBUG
-    Serial.println("EnabledState");
-#endif
-    CartBot::GetInstance().SetMotorSpeed( 15000, 15000 );
-    CartBot::GetDisplay().Print(
-    	"                    ",
-    	"                    ",
-    	"                    "
+    enabled.forward = enabled.turn = 0;
+    enabled.leftSpeed = enabled.rightSpeed = 1500;
+    SetMotorSpeed( 1500, 1500 );
+    display.Print(
+    	FLASH_ROW("                    "),
+    	FLASH_ROW("                    "),
+    	FLASH_ROW("                    ")
     );
 }
 
-void EnabledState::UpdateState()
+bool CartBot::IsDisabled() const
 {
-    if (CartBot::GetInstance().IsChargeNeeded())
-    {
-#ifdef SERIAL_DEBUG
-	Serial.println("EnabledState -> BatteryFaultState");
-#endif
-	CartBot::GetInstance().ChangeState(&CartBot::batteryFaultState);
-    }
-    else if (!CartBot::GetInstance().IsEnabled())
-    {
-#ifdef SERIAL_DEBUG
-	Serial.println("EnabledState -> DisabledState");
-#endif
-	CartBot::GetInstance().ChangeState(&CartBot::disabledState);
-    }
+    return !IsEnabled();
 }
 
-void EnabledState::UpdateOutputs()
+void CartBot::UpdateOutputsEnabled()
 {
-    int joyx = CartBot::GetInstance().GetJoyX();
-    int joyy = CartBot::GetInstance().GetJoyY();
+    enabled.forward = joystickCal.Y().Deflection(joyy);
+    enabled.turn = joystickCal.X().Deflection(joyx);
 
-    if (joyy > 512 + DEADBAND) {
-	forward = joyy - (512 + DEADBAND);
-    } else if (joyy < 512 - DEADBAND) {
-	forward = joyy - (512 - DEADBAND);  // reverse motion
-    } else {
-	forward = 0;
-    }
-
-    if (joyx > 512 + DEADBAND) {
-	turn = joyx - (512 + DEADBAND);
-    } else if (joyx < 512 - DEADBAND) {
-	turn = joyx - (512 - DEADBAND);
-    } else {
-	turn = 0;
-    }
-
-    leftSpeed = 1500 + forward + turn / 3;
+    int leftSpeed = 1500 + enabled.forward + enabled.turn / 3;
     if (leftSpeed > FORWARD_LIMIT) leftSpeed = FORWARD_LIMIT;
     if (leftSpeed < REVERSE_LIMIT) leftSpeed = REVERSE_LIMIT;
 
-    rightSpeed = 1500 + forward - turn / 3;
+    int rightSpeed = 1500 + enabled.forward - enabled.turn / 3;
     if (rightSpeed > FORWARD_LIMIT) rightSpeed = FORWARD_LIMIT;
     if (rightSpeed < REVERSE_LIMIT) rightSpeed = REVERSE_LIMIT;
 
-    CartBot::GetInstance().SetMotorSpeed( leftSpeed, rightSpeed );
+    enabled.leftSpeed = leftSpeed;
+    enabled.rightSpeed = rightSpeed;
+    SetMotorSpeed( leftSpeed, rightSpeed );
 }
 
-void EnabledState::UpdateDisplay()
+void CartBot::UpdateDisplayEnabled()
 {
-    LiquidCrystal_I2C &lcd = CartBot::GetDisplay().lcd;
+    int forward = enabled.forward;
+    int turn = enabled.turn;
 
 #ifdef DEBUG_MOTORS
-    lcd.setCursor(0,0);
-    lcd.print(leftSpeed);
-
-    lcd.setCursor(16,0);
-    lcd.print(rightSpeed);
+    char speed[5];
+    speed[4] = '\0';
+    itoa4(speed, enabled.leftSpeed);
+    display.Print(0, 0, speed);
+    itoa4(speed, enabled.rightSpeed);
+    display.Print(0, 16, speed);
 #endif
 
-    lcd.setCursor(10,0);
-    lcd.write((forward > FAST) ? CHAR_UP : ' ');
+    char fast[2] = { (char) ((forward > FAST) ? CHAR_UP : ' '), '\0' };
+    display.Print(0, 10, fast);
 
-    lcd.setCursor(9,1);
-    lcd.write((turn < 0) ? CHAR_LEFT : ' ');
-    lcd.write((forward > 0) ? CHAR_UP :
-    	      (forward < 0) ? CHAR_DOWN :
-	      CHAR_BULLET);
-    lcd.write((turn > 0) ? CHAR_RIGHT : ' ');
+    char arrows[4] = {
+	(char) ((turn < 0) ? CHAR_LEFT : ' '),
+	(char) ((forward > 0) ? CHAR_UP :
+		(forward < 0) ? CHAR_DOWN :
+		CHAR_BULLET),
+	(char) ((turn > 0) ? CHAR_RIGHT : ' '),
+	'\0'
+    };
+    display.Print(1, 9, arrows);
 
-    CartBot::GetInstance().ShowBatteryStatus();
+    ShowBatteryStatus();
 }
 
 ////////////////////////////////////////
@@ -344,64 +287,32 @@ void EnabledState::UpdateDisplay()
 //
 ////////////////////////////////////////
 
-ControlFaultState::ControlFaultState()
-{
-    ;
-}
-
-ControlFaultState::~ControlFaultState()
-{
-    ;
-}
-
-void ControlFaultState::EnterState()
+void CartBot::EnterControlFault()
 {
-#ifdef SERIAL_DEBUG
-    Serial.println("ControlFaultState");
-#endif
-    CartBot::GetInstance().DisableMotors();
-    CartBot::GetDisplay().Print(
-	"      DISABLED      ",
-	"                    ",
-	"                    "
+    blackbox.Freeze();
+    display.Print(
+	FLASH_ROW("      DISABLED      "),
+	FLASH_ROW("                    "),
+	FLASH_ROW("                    ")
     );
 }
 
-void ControlFaultState::UpdateState()
+bool CartBot::IsControlReleased() const
 {
-    if (CartBot::GetInstance().IsChargeNeeded())
-    {
-#ifdef SERIAL_DEBUG
-	Serial.println("ControlFaultState -> BatteryFaultState");
-#endif
-	CartBot::GetInstance().ChangeState(&CartBot::batteryFaultState);
-    }
-    else if (! CartBot::GetInstance().IsEnabled() &&
-	     CartBot::GetInstance().IsJoystickCentered())
-    {
-#ifdef SERIAL_DEBUG
-	Serial.println("ControlFaultState -> InitState");
-#endif
-	CartBot::GetInstance().ChangeState(&CartBot::initState);
-    }
+    return !IsEnabled() && IsJoystickCentered();
 }
 
-void ControlFaultState::UpdateOutputs()
+void CartBot::UpdateOutputsControlFault()
 {
-    if (CartBot::GetInstance().IsEnabled()) {
-	CartBot::GetDisplay().Print(1, " release the button ");
-    } else if (! CartBot::GetInstance().IsJoystickCentered()) {
-	CartBot::GetDisplay().Print(1, "release the joystick");
+    if (IsEnabled()) {
+	display.Print(1, FLASH_ROW(" release the button "));
+    } else if (!IsJoystickCentered()) {
+	display.Print(1, FLASH_ROW("release the joystick"));
     } else { // "can't happen"
-	CartBot::GetDisplay().Print(1, " release the kraken ");
+	display.Print(1, FLASH_ROW(" release the kraken "));
     }
 }
 
-void ControlFaultState::UpdateDisplay()
-{
-    ;
-}
-
 ////////////////////////////////////////
 //
 // BatteryFault:
@@ -410,44 +321,16 @@ void ControlFaultState::UpdateDisplay()
 //
 ////////////////////////////////////////
 
-BatteryFaultState::BatteryFaultState()
+void CartBot::EnterBatteryFault()
 {
-    ;
-}
-
-BatteryFaultState::~BatteryFaultState()
-{
-    ;
-}
-
-void BatteryFaultState::EnterState()
-{
-#ifdef SERIAL_DEBUG
-    Serial.println("BatteryFaultState");
-#endif
-    CartBot::GetInstance().DisableMotors();
-    CartBot::GetDisplay().Print(
-	"  BATTERY TOO LOW   ",
-	"  Recharge battery  ",
-	"  before operating  "
+    blackbox.Freeze();
+    display.Print(
+	FLASH_ROW("  BATTERY TOO LOW   "),
+	FLASH_ROW("  Recharge battery  "),
+	FLASH_ROW("  before operating  ")
     );
 }
 
-void BatteryFaultState::UpdateState()
-{
-    ;
-}
-
-void BatteryFaultState::UpdateOutputs()
-{
-    ;
-}
-
-void BatteryFaultState::UpdateDisplay()
-{
-    ;
-}
-
 ////////////////////////////////////////
 //
 // Test:
@@ -459,185 +342,98 @@ void BatteryFaultState::UpdateDisplay()
 //
 ////////////////////////////////////////
 
-TestState::TestState()
+void CartBot::EnterTest()
 {
-    ;
-}
-
-TestState::~TestState()
-{
-    ;
-}
-
-void TestState::EnterState()
-{
-#ifdef SERIAL_DEBUG
-    Serial.println("TestState");
-#endif
-    CartBot::GetInstance().DisableMotors();
-    CartBot::GetDisplay().Print(
-    	"Vbat xx.x Venbl xx.x",
-	"JoyX xx.x JoyY  xx.x",
-	"Left x.xx Right x.xx"
+    display.Print(
+    	FLASH_ROW("Vbat xx.x Venbl xx.x"),
+	FLASH_ROW("JoyX xx.x JoyY  xx.x"),
+	FLASH_ROW("Left x.xx Right x.xx")
     );
-    displayMode = 0;
-    buttonPressed = true;
-    debounce = 0;
-    leftSpeed = rightSpeed = 1500;
+    test.displayMode = 0;
+    test.buttonPressed = true;
+    test.debounce = 0;
+    test.leftSpeed = test.rightSpeed = 1500;
 }
 
-void TestState::UpdateState()
+void CartBot::UpdateTest()
 {
-    if (debounce) {
-	--debounce;
+    if (test.debounce) {
+	--test.debounce;
     }
     if (!digitalRead(TEST_PIN)) {	// input low == pressed
-	if (!buttonPressed) {		// wasn't previously pressed
-	    if (debounce == 0) {	// if we're past the debounce time
-		if (++displayMode > 2)	// advance mode
-		    displayMode = 0;
+	if (!test.buttonPressed) {	// wasn't previously pressed
+	    if (test.debounce == 0) {	// if we're past the debounce time
+		if (++test.displayMode > 2)	// advance mode
+		    test.displayMode = 0;
 	    }
-	    buttonPressed = true;	// record button press
-	    debounce = DEBOUNCE_TIME;	// (re)start the debounce timer
+	    test.buttonPressed = true;	// record button press
+	    test.debounce = DEBOUNCE_TICKS;	// (re)start the debounce timer
 	}
     } else {				// input high == released
-	if (buttonPressed) {		// was previously pressed
-	    buttonPressed = false;	// record button release
-	    debounce = DEBOUNCE_TIME;	// (re)start the debounce timer
+	if (test.buttonPressed) {	// was previously pressed
+	    test.buttonPressed = false;	// record button release
+	    test.debounce = DEBOUNCE_TICKS;	// (re)start the debounce timer
 	}
     }
 }
 
-void TestState::UpdateOutputs()
+void CartBot::UpdateOutputsTest()
 {
-    int joyx = CartBot::GetInstance().GetJoyX();
-    int joyy = CartBot::GetInstance().GetJoyY();
-    if (joyx < 512 + DEADBAND) {
-	leftSpeed = (joyy < 512 - DEADBAND) ? 1000
-	     : (joyy > 512 + DEADBAND) ? 2000
+    int forward = joystickCal.Y().Deflection(joyy);
+    int turn = joystickCal.X().Deflection(joyx);
+
+    if (turn <= 0) {
+	test.leftSpeed = (forward < 0) ? 1000
+	     : (forward > 0) ? 2000
 	     : 1500;
     } else {
-	leftSpeed = 1500;
+	test.leftSpeed = 1500;
     }
-    if (joyx > 512 - DEADBAND) {
-	rightSpeed = (joyy < 512 - DEADBAND) ? 1000
-	     : (joyy > 512 + DEADBAND) ? 2000
+    if (turn >= 0) {
+	test.rightSpeed = (forward < 0) ? 1000
+	     : (forward > 0) ? 2000
 	     : 1500;
     } else {
-	rightSpeed = 1500;
+	test.rightSpeed = 1500;
     }
 
-    CartBot::GetInstance().SetMotorSpeed( leftSpeed, rightSpeed );
-}
-
-void itoa4( char *buf, int n )
-{
-    int d = n % 10;
-    buf[3] = '0' + d;
-    n /= 10;
-    if (n) {
-	d = n % 10;
-	buf[2] = '0' + d;
-	n /= 10;
-	if (n) {
-	    d = n % 10;
-	    buf[1] = '0' + d;
-	    n /= 10;
-	    if (n) {
-		d = n % 10;
-		buf[0] = '0' + d;
-		n /= 10;
-		if (n) {
-		    // out of range
-		    buf[0] = buf[1] = buf[2] = buf[3] = '-';
-		}
-	    } else {
-		buf[0] = ' ';
-	    }
-	} else {
-	    buf[1] = buf[0] = ' ';
-	}
-    } else {
-	buf[2] = buf[1] = buf[0] = ' ';
-    }
-}
-
-void ftoa2x1( char *buf, float f )
-{
-    int n = (f * 10. + 0.5);
-    int d = n % 10;
-    buf[3] = '0' + d;
-    buf[2] = '.';
-    n /= 10;
-    d = n % 10;
-    buf[1] = '0' + d;
-    n /= 10;
-    if (n) {
-	d = n % 10;
-	buf[0] = '0' + d;
-	n /= 10;
-	if (n) {
-	    // out of range
-	    buf[0] = buf[1] = buf[2] = buf[3] = '-';
-	}
-    } else {
-	buf[0] = ' ';
-    }
-}
-
-void ftoa1x2( char *buf, float f )
-{
-    int n = (f * 100. + 0.5);
-    int d = n % 10;
-    buf[3] = '0' + d;
-    n /= 10;
-    d = n % 10;
-    buf[2] = '0' + d;
-    buf[1] = '.';
-    n /= 10;
-    d = n % 10;
-    buf[0] = '0' + d;
-    n /= 10;
-    if (n) {
-	// out of range
-	buf[0] = buf[1] = buf[2] = buf[3] = '-';
-    }
+    SetMotorSpeed( test.leftSpeed, test.rightSpeed );
 }
 
-void TestState::UpdateDisplay()
+void CartBot::UpdateDisplayTest()
 {
     char line1[21];
     char line2[21];
     char line3[21];
 
-    strcpy(line1, "Vbat xx.x Venbl xx.x");
-    strcpy(line2, "JoyX xx.x JoyY  xx.x");
-    strcpy(line3, "Left x.xx Right x.xx");
+    strcpy_P(line1, PSTR("Vbat xx.x Venbl xx.x"));
+    strcpy_P(line2, PSTR("JoyX xx.x JoyY  xx.x"));
+    strcpy_P(line3, PSTR("Left x.xx Right x.xx"));
 
-    switch (displayMode) {
+    switch (test.displayMode) {
     case 0:	// display raw A/D counts
-	itoa4( line1 + 5, CartBot::GetInstance().GetVBat() );
-	itoa4( line1 + 16, CartBot::GetInstance().GetVEnbl() );
-	itoa4( line2 + 5, CartBot::GetInstance().GetJoyX() );
-	itoa4( line2 + 16, CartBot::GetInstance().GetJoyY() );
+	itoa4( line1 + 5, vbat );
+	itoa4( line1 + 16, venbl );
+	itoa4( line2 + 5, joyx );
+	itoa4( line2 + 16, joyy );
 	break;
     case 1:	// display raw input voltage based on 5.00V ref
-	ftoa1x2( line1 + 5, CartBot::GetInstance().GetVBat() * 5.00 / 1024. );
-	ftoa1x2( line1 + 16, CartBot::GetInstance().GetVEnbl() * 5.00 / 1024.);
-	ftoa1x2( line2 + 5, CartBot::GetInstance().GetJoyX() * 5.00 / 1024. );
-	ftoa1x2( line2 + 16, CartBot::GetInstance().GetJoyY() * 5.00 / 1024.);
+	fixtoa1x2( line1 + 5, ADC_CENTIVOLTS.Apply(vbat) );
+	fixtoa1x2( line1 + 16, ADC_CENTIVOLTS.Apply(venbl) );
+	fixtoa1x2( line2 + 5, ADC_CENTIVOLTS.Apply(joyx) );
+	fixtoa1x2( line2 + 16, ADC_CENTIVOLTS.Apply(joyy) );
 	break;
     case 2:	// display calculated input voltage based on divider
-	ftoa2x1( line1 + 5, CartBot::GetInstance().GetVBat() * 5.00 / 1024. * (15.1e3 / 5.1e3));
-	ftoa2x1( line1 + 16, CartBot::GetInstance().GetVEnbl() * 5.00 / 1024. * (15.1e3 / 5.1e3));
-	ftoa2x1( line2 + 5, CartBot::GetInstance().GetJoyX() * 100.0 / 1024.);
-	ftoa2x1( line2 + 16, CartBot::GetInstance().GetJoyY() * 100.0 / 1024.);
+	fixtoa2x1( line1 + 5, VBAT_DECIVOLTS.Apply(vbat) );
+	fixtoa2x1( line1 + 16, VBAT_DECIVOLTS.Apply(venbl) );
+	fixtoa2x1( line2 + 5, ADC_PERMILLE.Apply(joyx) );
+	fixtoa2x1( line2 + 16, ADC_PERMILLE.Apply(joyy) );
 	break;
     }
-    ftoa1x2( line3 + 5, leftSpeed / 1000. );
-    ftoa1x2( line3 + 16, rightSpeed / 1000. );
+    fixtoa1x2( line3 + 5, PULSE_CENTIMS.Apply(test.leftSpeed) );
+    fixtoa1x2( line3 + 16, PULSE_CENTIMS.Apply(test.rightSpeed) );
 
-    CartBot::GetDisplay().Print( line1, line2, line3 );
+    display.Print( line1, line2, line3 );
 }
 
 ////////////////////////////////////////
@@ -7,101 +7,31 @@
 ** https://bitbucket.org/fmalpartida/new-liquidcrystal 
 */
 
-class State {
-public:
-    State();
-    virtual ~State();
-    void ResetTimer();
-    virtual void EnterState() = 0;
-    virtual void UpdateState() = 0;
-    virtual void UpdateOutputs() = 0;
-    virtual void UpdateDisplay() = 0;
-
-private:
-    unsigned long startTime;	// in milliseconds
-
-protected:
-    unsigned long TimeInState();
-};
-
-class PowerOnState : public State {
-public:
-    PowerOnState();
-    virtual ~PowerOnState();
-    virtual void EnterState();
-    virtual void UpdateState();
-    virtual void UpdateOutputs();
-    virtual void UpdateDisplay();
-};
-
-class InitState : public State {
-public:
-    InitState();
-    virtual ~InitState();
-    virtual void EnterState();
-    virtual void UpdateState();
-    virtual void UpdateOutputs();
-    virtual void UpdateDisplay();
-};
-
-class DisabledState : public State {
-public:
-    DisabledState();
-    virtual ~DisabledState();
-    virtual void EnterState();
-    virtual void UpdateState();
-    virtual void UpdateOutputs();
-    virtual void UpdateDisplay();
-};
-
-class EnabledState : public State {
-public:
-    EnabledState();
-    virtual ~EnabledState();
-    virtual void EnterState();
-    virtual void UpdateState();
-    virtual void UpdateOutputs();
-    virtual void UpdateDisplay();
-private:
+// Operating states.  Their actions are CartBot members and the
+// transitions between them are a table, all in State.cpp.
+enum StateId {
+    STATE_POWER_ON,
+    STATE_INIT,
+    STATE_DISABLED,
+    STATE_ENABLED,
+    STATE_CONTROL_FAULT,
+    STATE_BATTERY_FAULT,
+    STATE_TEST,
+    NUM_STATES
+};
+
+// working data of the states that keep any
+struct EnabledData {
     int forward;
     int turn;
     int leftSpeed;
     int rightSpeed;
 };
 
-class ControlFaultState : public State {
-public:
-    ControlFaultState();
-    virtual ~ControlFaultState();
-    virtual void EnterState();
-    virtual void UpdateState();
-    virtual void UpdateOutputs();
-    virtual void UpdateDisplay();
-};
-
-class BatteryFaultState : public State {
-public:
-    BatteryFaultState();
-    virtual ~BatteryFaultState();
-    virtual void EnterState();
-    virtual void UpdateState();
-    virtual void UpdateOutputs();
-    virtual void UpdateDisplay();
-};
-
-class TestState : public State {
-public:
-    TestState();
-    virtual ~TestState();
-    virtual void EnterState();
-    virtual void UpdateState();
-    virtual void UpdateOutputs();
-    virtual void UpdateDisplay();
-public:
+struct TestData {
     int displayMode;
     bool buttonPressed;
     int debounce;
     int leftSpeed;
     int rightSpeed;
 };
-
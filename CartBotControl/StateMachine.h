@@ -0,0 +1,230 @@
+#pragma once
+/*
+** CartBot control software
+** Stephen Tarr - FRC Team 1425 "Error Code Xero"
+**
+** This code depends on F Malpartida's NewLiquidCrystal library:
+** https://bitbucket.org/fmalpartida/new-liquidcrystal 
+*/
+#include <Arduino.h>
+#include <stdint.h>
+
+// Table-driven state machine.  States and transitions are constant
+// tables of the owner's member functions, like the Scheduler's tasks, so
+// a tick costs a few indirect calls and no virtual dispatch.  The tables
+// live in flash; entries are copied out as they are needed.
+//
+// Each control period UpdateState() takes the first transition out of
+// the current state whose guard holds; if none does, the state's update
+// runs.  A guard is only tried when one of the events it depends on has
+// come in, and once on the first tick in a state to pick up conditions
+// that were already true on the way in.
+// React() tries the transitions an event triggers between control
+// periods, for inputs that can't wait for the next one.
+// A chosen transition is only taken by Apply() at the end of the tick:
+// exit action, transition action, then entry action.  Until then the
+// state stays put but no longer drives the outputs.
+template <class T, int S, int N>
+class StateMachine {
+public:
+    typedef void (T::*Action)();
+    typedef bool (T::*Guard)() const;
+
+    struct State {
+	PGM_P name;
+	Action enter;
+	Action exit;
+	Action update;		// each control period, unless leaving
+	Action outputs;		// likewise, after update
+	Action display;		// each display refresh
+    };
+
+    struct Transition {
+	uint8_t from;		// transitions are grouped by 'from'
+	uint8_t to;
+	uint8_t trigger;	// events that make the guard worth trying
+	Guard guard;		// NULL: always
+	Action action;		// NULL: none
+	PGM_P label;		// for the graph
+    };
+
+    StateMachine( const State *states, const Transition *transitions )
+      : states(states), transitions(transitions),
+	current(0), pending(NONE), fresh(true), entered(0)
+    {
+    }
+
+    // enter the initial state now
+    void Start( T &owner, uint8_t initial )
+    {
+	current = initial;
+	pending = NONE;
+	fresh = true;
+	entered = millis();
+	Run(owner, GetState(current).enter);
+    }
+
+    void UpdateState( T &owner, uint8_t events )
+    {
+	if (pending != NONE) {
+	    return;
+	}
+	if (fresh) {
+	    events = 0xFF;
+	    fresh = false;
+	}
+	if (!Choose(owner, events)) {
+	    Run(owner, GetState(current).update);
+	}
+    }
+
+    // like UpdateState() but without the state's update; a fresh state
+    // is left for its first UpdateState() to try everything
+    void React( T &owner, uint8_t events )
+    {
+	if (pending == NONE && !fresh) {
+	    Choose(owner, events);
+	}
+    }
+
+    void UpdateOutputs( T &owner )
+    {
+	if (pending == NONE) {
+	    Run(owner, GetState(current).outputs);
+	}
+    }
+
+    void UpdateDisplay( T &owner )
+    {
+	Run(owner, GetState(current).display);
+    }
+
+    // take the transition chosen this tick, if any
+    void Apply( T &owner )
+    {
+	if (pending == NONE) {
+	    return;
+	}
+	Transition t = GetTransition(pending);
+	Run(owner, GetState(current).exit);
+	Run(owner, t.action);
+#ifdef SERIAL_DEBUG
+	PrintP(Serial, GetState(current).name);
+	Serial.print(" -> ");
+	PrintP(Serial, GetState(t.to).name);
+	Serial.println();
+#endif
+	current = t.to;
+	pending = NONE;
+	fresh = true;
+	entered = millis();
+	Run(owner, GetState(current).enter);
+    }
+
+    uint8_t Current() const { return current; }
+
+    unsigned long TimeInState() const
+    {
+	return millis() - entered;
+    }
+
+    // the tables as a Graphviz digraph
+    void Dump( Print &out, const char *graph ) const
+    {
+	out.print("digraph ");
+	out.print(graph);
+	out.println(" {");
+	for (uint8_t s = 0; s < S; s++) {
+	    out.print("    \"");
+	    PrintP(out, GetState(s).name);
+	    out.println("\";");
+	}
+	for (uint8_t i = 0; i < N; i++) {
+	    Transition t = GetTransition(i);
+	    out.print("    \"");
+	    PrintP(out, GetState(t.from).name);
+	    out.print("\" -> \"");
+	    PrintP(out, GetState(t.to).name);
+	    out.print("\" [label=\"");
+	    PrintP(out, t.label);
+	    out.println("\"];");
+	}
+	out.println("}");
+    }
+
+    // for static_assert: the table is the right size, grouped by
+    // 'from', and names only states that exist
+    template <int M>
+    static constexpr bool Valid( const Transition (&t)[M] )
+    {
+	return M == N && Valid(t, 0);
+    }
+
+private:
+    enum { NONE = 0xFF };
+
+    static constexpr bool Valid( const Transition *t, int i )
+    {
+	return i == N ||
+	       (t[i].from < S && t[i].to < S &&
+		(i == 0 || t[i - 1].from <= t[i].from) &&
+		Valid(t, i + 1));
+    }
+
+    // pick the first transition out of the current state that 'events'
+    // trigger and whose guard holds
+    bool Choose( T &owner, uint8_t events )
+    {
+	for (uint8_t i = 0; i < N; i++) {
+	    uint8_t from = pgm_read_byte(&transitions[i].from);
+	    if (from > current) {
+		break;
+	    }
+	    if (from == current &&
+		(pgm_read_byte(&transitions[i].trigger) & events)) {
+		Transition t = GetTransition(i);
+		if (!t.guard || (owner.*t.guard)()) {
+		    pending = i;
+		    return true;
+		}
+	    }
+	}
+	return false;
+    }
+
+    State GetState( uint8_t i ) const
+    {
+	State s;
+	memcpy_P(&s, &states[i], sizeof s);
+	return s;
+    }
+
+    Transition GetTransition( uint8_t i ) const
+    {
+	Transition t;
+	memcpy_P(&t, &transitions[i], sizeof t);
+	return t;
+    }
+
+    void Run( T &owner, Action action )
+    {
+	if (action) {
+	    (owner.*action)();
+	}
+    }
+
+    static void PrintP( Print &out, PGM_P s )
+    {
+	char c;
+	while ((c = pgm_read_byte(s++)) != '\0') {
+	    out.print(c);
+	}
+    }
+
+    const State *states;
+    const Transition *transitions;
+    uint8_t current;
+    uint8_t pending;		// index of the transition to take
+    bool fresh;			// no ticks in this state yet
+    unsigned long entered;	// millis() on entry
+};
@@ -0,0 +1,178 @@
+/*
+** CartBot control software
+** Stephen Tarr
+** FRC Team 1425 "Error Code Xero"
+**
+** This code depends on F Malpartida's NewLiquidCrystal library:
+** https://bitbucket.org/fmalpartida/new-liquidcrystal 
+*/
+#include "Telemetry.h"
+
+static uint8_t *Put16( uint8_t *p, uint16_t v )
+{
+    *p++ = v & 0xFF;
+    *p++ = v >> 8;
+    return p;
+}
+
+static uint16_t Get16( const uint8_t *p )
+{
+    return p[0] | (p[1] << 8);
+}
+
+void Telemetry::Pack( const TelemetryFrame &f, uint8_t *buf )
+{
+    uint8_t *p = buf;
+    *p++ = f.seq;
+    p = Put16(p, f.ms);
+    *p++ = f.state;
+    *p++ = f.inputs;
+    p = Put16(p, f.joyx);
+    p = Put16(p, f.joyy);
+    p = Put16(p, f.vbat);
+    p = Put16(p, f.venbl);
+    p = Put16(p, f.left);
+    p = Put16(p, f.right);
+    p = Put16(p, f.tickMax);
+    *p++ = f.overruns;
+    Put16(p, Crc(buf, PAYLOAD));
+}
+
+bool Telemetry::Unpack( const uint8_t *buf, uint8_t n, TelemetryFrame &f )
+{
+    if (n != PACKED || Get16(buf + PAYLOAD) != Crc(buf, PAYLOAD)) {
+	return false;
+    }
+    f.seq = buf[0];
+    f.ms = Get16(buf + 1);
+    f.state = buf[3];
+    f.inputs = buf[4];
+    f.joyx = Get16(buf + 5);
+    f.joyy = Get16(buf + 7);
+    f.vbat = Get16(buf + 9);
+    f.venbl = Get16(buf + 11);
+    f.left = Get16(buf + 13);
+    f.right = Get16(buf + 15);
+    f.tickMax = Get16(buf + 17);
+    f.overruns = buf[19];
+    return true;
+}
+
+uint8_t Telemetry::Stuff( const uint8_t *in, uint8_t n, uint8_t *out )
+{
+    uint8_t code = 0;		// where this block's length goes
+    uint8_t len = 1;
+    for (uint8_t i = 0; i < n; i++) {
+	if (in[i] == 0) {
+	    out[code] = len - code;
+	    code = len++;
+	} else {
+	    out[len++] = in[i];
+	}
+    }
+    out[code] = len - code;
+    return len;
+}
+
+uint8_t Telemetry::Unstuff( const uint8_t *in, uint8_t n, uint8_t *out )
+{
+    uint8_t len = 0;
+    uint8_t i = 0;
+    while (i < n) {
+	uint8_t code = in[i++];
+	if (code == 0 || i + code - 1 > n) {
+	    return 0;
+	}
+	for (uint8_t k = 1; k < code; k++) {
+	    out[len++] = in[i++];
+	}
+	if (i < n) {
+	    out[len++] = 0;
+	}
+    }
+    return len;
+}
+
+// CRC-16/CCITT-FALSE: polynomial 0x1021, starting from 0xFFFF
+uint16_t Telemetry::Crc( const uint8_t *p, uint8_t n )
+{
+    uint16_t crc = 0xFFFF;
+    while (n--) {
+	crc ^= (uint16_t) *p++ << 8;
+	for (uint8_t i = 0; i < 8; i++) {
+	    crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+	}
+    }
+    return crc;
+}
+
+Telemetry::Telemetry()
+  : on(false), seq(0), tickMax(0), tail(0), used(0)
+{
+    ;
+}
+
+#ifdef TELEMETRY
+
+void Telemetry::SetOn( bool enable )
+{
+    // a partly sent frame is cut off; the receiver drops it by its CRC
+    tail = used = 0;
+    on = enable;
+    if (on) {
+	Put(0);		// so the first frame starts clean
+    }
+}
+
+void Telemetry::Tick( unsigned long us )
+{
+    if (us > tickMax) {
+	tickMax = us > 0xFFFF ? 0xFFFF : us;
+    }
+}
+
+void Telemetry::Put( uint8_t b )
+{
+    ring[(tail + used) % TELEMETRY_RING] = b;
+    ++used;
+}
+
+void Telemetry::Send( TelemetryFrame &f )
+{
+    if (!on) {
+	return;
+    }
+    f.seq = seq++;
+    f.tickMax = tickMax;
+    tickMax = 0;
+    if (used + FRAME > TELEMETRY_RING) {
+	return;
+    }
+
+    uint8_t packed[PACKED];
+    uint8_t stuffed[PACKED + 1];
+    Pack(f, packed);
+    uint8_t n = Stuff(packed, PACKED, stuffed);
+    for (uint8_t i = 0; i < n; i++) {
+	Put(stuffed[i]);
+    }
+    Put(0);
+}
+
+void Telemetry::Flush( HardwareSerial &port )
+{
+    int room = port.availableForWrite();
+    while (used && room-- > 0) {
+	port.write(ring[tail]);
+	tail = (tail + 1) % TELEMETRY_RING;
+	--used;
+    }
+}
+
+#else
+
+void Telemetry::SetOn( bool )
+{
+}
+
+#endif
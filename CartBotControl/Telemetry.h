@@ -0,0 +1,84 @@
+#pragma once
+/*
+** CartBot control software
+** Stephen Tarr - FRC Team 1425 "Error Code Xero"
+**
+** This code depends on F Malpartida's NewLiquidCrystal library:
+** https://bitbucket.org/fmalpartida/new-liquidcrystal 
+*/
+#include <Arduino.h>
+#include "Hardware.h"
+
+// what goes out each TELEMETRY_PERIOD
+struct TelemetryFrame {
+    uint8_t seq;		// filled in by Send(); gaps are lost frames
+    uint16_t ms;		// millis(), low bits
+    uint8_t state;
+    uint8_t inputs;		// debounced, a bit per InputId
+    int16_t joyx, joyy, vbat, venbl;	// A2D units
+    int16_t left, right;	// servo pulses, microseconds; 0 detached
+    uint16_t tickMax;		// longest tick since the last frame, us
+				// (0 without LOOP_STATS)
+    uint8_t overruns;		// running count, low bits
+};
+
+// Binary telemetry over the serial port.  A frame is the fields above,
+// little-endian, then a CRC-16/CCITT of them; COBS-stuffed so the only
+// zero is the delimiter after it.  A receiver that comes in mid-stream,
+// or sees a frame spoiled by text from a serial command, drops bytes
+// up to the next zero and carries on.
+//
+// Send() only queues the frame in a ring; Flush() hands the port no more
+// than availableForWrite() each tick, so the loop never waits on the
+// UART.  If the ring is too full for a whole frame it is dropped and the
+// gap in 'seq' shows it.  Host/telemrx turns the stream into CSV.
+class Telemetry {
+public:
+    enum {
+	PAYLOAD = 20,			// packed fields
+	PACKED = PAYLOAD + 2,		// ... and the CRC
+	FRAME = PACKED + 2		// stuffed, and the delimiter
+    };
+
+    Telemetry();
+
+    // streaming starts off, so a serial monitor isn't flooded with binary
+    void SetOn( bool on );
+    bool IsOn() const { return on; }
+
+    // Tick(), Send() and Flush() compile away when TELEMETRY is not defined
+    void Tick( unsigned long us );
+    void Send( TelemetryFrame &f );
+    void Flush( HardwareSerial &port );
+
+    // fields and CRC into 'buf', PACKED bytes
+    static void Pack( const TelemetryFrame &f, uint8_t *buf );
+    // false if the length or the CRC is wrong
+    static bool Unpack( const uint8_t *buf, uint8_t n, TelemetryFrame &f );
+
+    // COBS without the delimiter; frames are short enough (under 254
+    // bytes) that every block ends at a zero or at the end
+    static uint8_t Stuff( const uint8_t *in, uint8_t n, uint8_t *out );
+    // 0 if malformed
+    static uint8_t Unstuff( const uint8_t *in, uint8_t n, uint8_t *out );
+
+    static uint16_t Crc( const uint8_t *p, uint8_t n );
+
+private:
+    void Put( uint8_t b );
+
+    bool on;
+    uint8_t seq;
+    uint16_t tickMax;
+#ifdef TELEMETRY
+    uint8_t ring[TELEMETRY_RING];
+#endif
+    uint8_t tail;		// next byte to send
+    uint8_t used;
+};
+
+#ifndef TELEMETRY
+inline void Telemetry::Tick( unsigned long ) { }
+inline void Telemetry::Send( TelemetryFrame & ) { }
+inline void Telemetry::Flush( HardwareSerial & ) { }
+#endif
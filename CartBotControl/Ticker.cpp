@@ -0,0 +1,125 @@
+/*
+** CartBot control software
+** Stephen Tarr
+** FRC Team 1425 "Error Code Xero"
+**
+** This code depends on F Malpartida's NewLiquidCrystal library:
+** https://bitbucket.org/fmalpartida/new-liquidcrystal 
+*/
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include "Ticker.h"
+
+// Timer0 runs millis() and Timer1 belongs to the Servo library, so the
+// tick uses Timer2 in CTC mode: 16 MHz / 128 / 125 = exactly 1 kHz
+#define	TICK_PRESCALE	128
+#define	TICK_HZ		1000
+
+unsigned long Ticker::when;
+unsigned long Ticker::count;
+
+#ifdef TICK_INTERRUPT
+
+static volatile uint8_t pending;	// ticks not yet taken
+static volatile uint8_t phase;		// milliseconds into the current tick
+
+ISR(TIMER2_COMPA_vect)
+{
+    if (++phase >= LOOP_TIME) {
+	phase = 0;
+	if (pending != 0xFF) {
+	    ++pending;
+	}
+    }
+}
+
+void Ticker::Begin()
+{
+    cli();
+    pending = 0;
+    phase = 0;
+    TCCR2A = (1 << WGM21);			// CTC, TOP = OCR2A
+    TCCR2B = (1 << CS22) | (1 << CS20);		// clk/128
+    OCR2A = F_CPU / TICK_PRESCALE / TICK_HZ - 1;
+    TCNT2 = 0;
+    TIFR2 = (1 << OCF2A);
+    TIMSK2 = (1 << OCIE2A);
+    sei();
+    count = 0;
+}
+
+bool Ticker::Take( unsigned long &late )
+{
+    cli();
+    uint8_t p = pending;
+    uint8_t ms = phase;
+    if (p) {
+	--pending;
+    }
+    sei();
+
+    if (!p) {
+	return false;
+    }
+    late = (unsigned long) (p - 1) * LOOP_TIME + ms;
+    ++count;
+    return true;
+}
+
+void Ticker::Idle()
+{
+    // interrupts stay off from the check until the sleep instruction;
+    // the instruction after sei always executes, so a tick arriving in
+    // between still wakes us
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    cli();
+    if (!pending) {
+	sleep_enable();
+	sei();
+	sleep_cpu();
+	sleep_disable();
+    }
+    sei();
+}
+
+unsigned long Ticker::Deadline()
+{
+    return millis();
+}
+
+#else // polled
+
+void Ticker::Begin()
+{
+    when = millis() + LOOP_TIME;
+    count = 0;
+}
+
+bool Ticker::Take( unsigned long &late )
+{
+    unsigned long now = millis();
+    if ((long)(now - when) < 0) {
+	return false;
+    }
+    late = now - when;
+    when += LOOP_TIME;
+    ++count;
+    return true;
+}
+
+void Ticker::Idle()
+{
+    ;
+}
+
+unsigned long Ticker::Deadline()
+{
+    return when;
+}
+
+#endif
+
+unsigned long Ticker::Count()
+{
+    return count;
+}
@@ -0,0 +1,36 @@
+#pragma once
+/*
+** CartBot control software
+** Stephen Tarr - FRC Team 1425 "Error Code Xero"
+**
+** This code depends on F Malpartida's NewLiquidCrystal library:
+** https://bitbucket.org/fmalpartida/new-liquidcrystal 
+*/
+#include <Arduino.h>
+#include "Hardware.h"
+
+// Main loop tick source.  With TICK_INTERRUPT defined, Timer2 raises a
+// compare interrupt every millisecond and counts off LOOP_TIME of them;
+// the CPU sleeps in idle mode between ticks.  Otherwise ticks come from
+// polling millis().
+class Ticker {
+public:
+    static void Begin();
+
+    // true when a tick is due; 'late' is how many milliseconds after
+    // its deadline the tick is being taken
+    static bool Take( unsigned long &late );
+
+    // wait for the next interrupt (returns at once when polling)
+    static void Idle();
+
+    // polled mode: millis() value of the next deadline
+    static unsigned long Deadline();
+
+    // ticks taken since Begin()
+    static unsigned long Count();
+
+private:
+    static unsigned long when;
+    static unsigned long count;
+};
@@ -0,0 +1,162 @@
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Simulated cart and driver.
+*/
+#include <stdlib.h>
+#include "Sim.h"
+#include "Scenario.h"
+#include "../CartBotControl/Hardware.h"
+
+#define TEST_RELEASED	1
+
+ScenarioParams::ScenarioParams()
+  : batteryStart(13.0), drainIdle(0.1), drainDrive(1.5), sag(0.4),
+    adcNoise(2), joyOffsetX(0), joyOffsetY(0),
+    idleMin(2), idleMax(20), driveMin(5), driveMax(60),
+    fumbleChance(0.05), bounce(0), joyWander(0)
+{
+    ;
+}
+
+Scenario::Scenario( const ScenarioParams &params, uint64_t seed )
+  : p(params), rng(seed * 2654435761u + 1), last(0),
+    activity(IDLE), activityEnd(0), nextWander(0), pressStart(0),
+    drained(0), battery(params.batteryStart), enable(false),
+    contact(false), enableChanged(0), contactChanged(0), bounceEnd(0),
+    wanderX(0), wanderY(0), targetX(512), targetY(512), joyx(512), joyy(512)
+{
+    // hands off through power-on and the control check
+    Begin(IDLE, 8 + Uniform(p.idleMin, p.idleMax));
+}
+
+int Scenario::VoltsToCounts( double volts )
+{
+    // 10k/5.1k divider into a 5.00V-referenced 10-bit converter
+    int counts = (int) (volts * (5.1 / 15.1) / 5.0 * 1024.0 + 0.5);
+    return counts < 0 ? 0 : counts > 1023 ? 1023 : counts;
+}
+
+uint32_t Scenario::Random()
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return (uint32_t) (rng >> 16);
+}
+
+double Scenario::Uniform( double lo, double hi )
+{
+    return lo + (hi - lo) * (Random() / 4294967296.0);
+}
+
+int Scenario::Noise()
+{
+    if (p.adcNoise <= 0) return 0;
+    return (int) (Random() % (2 * p.adcNoise + 1)) - p.adcNoise;
+}
+
+void Scenario::Begin( Activity next, double seconds )
+{
+    activity = next;
+    activityEnd = last + (uint64_t) (seconds * 1e6);
+}
+
+void Scenario::Press( bool on, uint64_t now )
+{
+    enable = on;
+    enableChanged = now;
+    if (p.bounce > 0) {
+	bounceEnd = now + (uint64_t) (Uniform(0, p.bounce) * 1e6);
+    }
+}
+
+// a random walk of a count a step, within +/- limit
+int Scenario::Creep( int at, int limit )
+{
+    at += (int) (Random() % 3) - 1;
+    return at < -limit ? -limit : at > limit ? limit : at;
+}
+
+bool Scenario::HandsOff() const
+{
+    return targetX == 512 && targetY == 512 && joyx == 512 && joyy == 512;
+}
+
+void Scenario::Step( uint64_t now )
+{
+    double dt = (now - last) * 1e-6;
+    last = now;
+
+    if (now >= activityEnd) {
+	switch (activity) {
+	case IDLE:
+	    if (Uniform(0, 1) < p.fumbleChance) {
+		targetX = 512;
+		targetY = 900;
+		Begin(GRAB, Uniform(0.5, 2));
+	    } else {
+		Press(true, now);
+		pressStart = now;
+		Begin(PRESS, 0.3);
+	    }
+	    break;
+	case GRAB:
+	    targetX = targetY = 512;
+	    Begin(IDLE, 3 + Uniform(p.idleMin, p.idleMax));
+	    break;
+	case PRESS:
+	    // the driver holds the button until the cart shows it is live
+	    if (!Sim::GetServoPulse(LEFTMOTOR_PIN) && now < pressStart + 3000000) {
+		break;
+	    }
+	    Begin(DRIVE, Uniform(p.driveMin, p.driveMax));
+	    nextWander = now;
+	    break;
+	case DRIVE:
+	    targetX = targetY = 512;
+	    Begin(STOP, 0.5);
+	    break;
+	case STOP:
+	    Press(false, now);
+	    Begin(IDLE, Uniform(p.idleMin, p.idleMax));
+	    break;
+	}
+    }
+
+    if (activity == DRIVE && now >= nextWander) {
+	targetX = 512 + (int) Uniform(-400, 400);
+	targetY = 512 + (int) Uniform(-300, 500);
+	nextWander = now + (uint64_t) (Uniform(0.5, 3) * 1e6);
+    }
+
+    // a hand moves the stick at about full travel per quarter second
+    int step = (int) (2048 * dt) + 1;
+    joyx += (targetX > joyx) ? (targetX - joyx < step ? targetX - joyx : step)
+				: -(joyx - targetX < step ? joyx - targetX : step);
+    joyy += (targetY > joyy) ? (targetY - joyy < step ? targetY - joyy : step)
+				: -(joyy - targetY < step ? joyy - targetY : step);
+
+    double throttle = enable ? abs(joyy - 512) / 512.0 : 0;
+    drained += (p.drainIdle + p.drainDrive * throttle) * dt / 3600.0;
+    battery = p.batteryStart - drained - p.sag * throttle;
+
+    // the contact chatters, a step at a time, after each press and release
+    bool was = contact;
+    contact = (now < bounceEnd) ? (Random() & 1) : enable;
+    if (contact != was) {
+	contactChanged = now;
+    }
+    if (p.joyWander > 0) {
+	wanderX = Creep(wanderX, p.joyWander);
+	wanderY = Creep(wanderY, p.joyWander);
+    }
+
+    int vbat = VoltsToCounts(battery);
+    Sim::SetAnalog(JOYX_PIN, joyx + p.joyOffsetX + wanderX + Noise());
+    Sim::SetAnalog(JOYY_PIN, joyy + p.joyOffsetY + wanderY + Noise());
+    Sim::SetAnalog(VBAT_PIN, vbat + Noise());
+    Sim::SetAnalog(VENBL_PIN, contact ? vbat + Noise() : 0);
+    Sim::SetDigital(TEST_PIN, TEST_RELEASED);
+}
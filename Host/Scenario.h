@@ -0,0 +1,75 @@
+#pragma once
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** A simulated cart and driver: battery with drain and sag under load,
+** an enable button that may bounce, and a joystick with pot drift,
+** wander and noise.  Step() turns the current situation into the
+** analog/digital levels the firmware reads.
+*/
+#include <stdint.h>
+
+struct ScenarioParams {
+    double batteryStart;	// volts at power-on
+    double drainIdle;		// volts per hour, motors stopped
+    double drainDrive;		// volts per hour, extra at full throttle
+    double sag;			// volts lost at full throttle
+    int adcNoise;		// +/- counts on every analog channel
+    int joyOffsetX;		// pot drift from 512, counts
+    int joyOffsetY;
+    double idleMin, idleMax;	// seconds hands-off between drives
+    double driveMin, driveMax;	// seconds per drive
+    double fumbleChance;	// chance a drive starts by grabbing the stick
+    double bounce;		// seconds the enable contact may chatter
+    int joyWander;		// +/- counts the idle stick creeps around
+
+    ScenarioParams();
+};
+
+class Scenario {
+public:
+    Scenario( const ScenarioParams &params, uint64_t seed );
+
+    // advance the driver and cart to virtual time 'now' (microseconds)
+    // and present the resulting inputs to the firmware
+    void Step( uint64_t now );
+
+    double Battery() const { return battery; }
+    bool EnablePressed() const { return enable; }	// by the driver
+    uint64_t EnableChanged() const { return enableChanged; }
+    uint64_t ContactChanged() const { return contactChanged; }	// bounce too
+    bool HandsOff() const;	// the stick is left at rest
+    int JoyX() const { return joyx; }
+    int JoyY() const { return joyy; }
+
+    static int VoltsToCounts( double volts );
+
+private:
+    enum Activity { IDLE, GRAB, PRESS, DRIVE, STOP };
+
+    uint32_t Random();
+    double Uniform( double lo, double hi );
+    int Noise();
+    void Begin( Activity next, double seconds );
+    void Press( bool on, uint64_t now );
+    int Creep( int at, int limit );
+
+    ScenarioParams p;
+    uint64_t rng;
+    uint64_t last;
+    Activity activity;
+    uint64_t activityEnd;
+    uint64_t nextWander;
+    uint64_t pressStart;
+    double drained;
+    double battery;
+    bool enable;
+    bool contact;		// what the button actually connects
+    uint64_t enableChanged;
+    uint64_t contactChanged;
+    uint64_t bounceEnd;
+    int wanderX, wanderY;
+    int targetX, targetY;
+    int joyx, joyy;
+};
@@ -0,0 +1,195 @@
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Input and output traces.
+*/
+#include <stdlib.h>
+#include <string.h>
+#include "Sim.h"
+#include "Trace.h"
+#include "../CartBotControl/Hardware.h"
+
+static const char *const inputNames[] = {
+    "ms", "joyx", "joyy", "vbat", "venbl", "test"
+};
+static const bool inputRequired[] = {
+    true, true, true, true, true, false
+};
+static const char *const outputNames[] = {
+    "ms", "state", "left", "right"
+};
+static const bool outputRequired[] = {
+    true, true, true, true
+};
+
+void TraceInputs::Present() const
+{
+    Sim::SetAnalog(JOYX_PIN, joyx);
+    Sim::SetAnalog(JOYY_PIN, joyy);
+    Sim::SetAnalog(VBAT_PIN, vbat);
+    Sim::SetAnalog(VENBL_PIN, venbl);
+    Sim::SetDigital(TEST_PIN, test);
+}
+
+TraceInputs TraceInputs::Capture( uint64_t us )
+{
+    TraceInputs in;
+    in.us = us;
+    in.joyx = Sim::GetAnalog(JOYX_PIN);
+    in.joyy = Sim::GetAnalog(JOYY_PIN);
+    in.vbat = Sim::GetAnalog(VBAT_PIN);
+    in.venbl = Sim::GetAnalog(VENBL_PIN);
+    in.test = Sim::GetInput(TEST_PIN);
+    return in;
+}
+
+TraceReader::TraceReader()
+  : file(NULL), path(NULL), line(0), count(0)
+{
+    ;
+}
+
+TraceReader::~TraceReader()
+{
+    if (file && file != stdin) {
+	fclose(file);
+    }
+}
+
+bool TraceReader::OpenInputs( const char *name )
+{
+    if (!Open(name, inputNames, inputRequired, 6)) {
+	return false;
+    }
+    fallback[5] = 1;		// test button released
+    return true;
+}
+
+bool TraceReader::OpenOutputs( const char *name )
+{
+    return Open(name, outputNames, outputRequired, 4);
+}
+
+bool TraceReader::Open( const char *name, const char *const *names,
+			const bool *required, int n )
+{
+    path = name;
+    file = strcmp(name, "-") ? fopen(name, "r") : stdin;
+    if (!file) {
+	perror(name);
+	return false;
+    }
+
+    char header[512];
+    if (!fgets(header, sizeof header, file)) {
+	fprintf(stderr, "%s: empty\n", name);
+	return false;
+    }
+    line = 1;
+    count = n;
+    for (int i = 0; i < n; i++) {
+	column[i] = -1;
+	fallback[i] = 0;
+    }
+
+    int at = 0;
+    for (char *field = strtok(header, ",\r\n"); field;
+	 field = strtok(NULL, ",\r\n"), at++) {
+	for (int i = 0; i < n; i++) {
+	    if (!strcmp(field, names[i])) {
+		column[i] = at;
+	    }
+	}
+    }
+    for (int i = 0; i < n; i++) {
+	if (required[i] && column[i] < 0) {
+	    fprintf(stderr, "%s: no '%s' column\n", name, names[i]);
+	    return false;
+	}
+    }
+    return true;
+}
+
+bool TraceReader::Row( double *values )
+{
+    char text[512];
+    double field[32];
+
+    if (!fgets(text, sizeof text, file)) {
+	return false;
+    }
+    ++line;
+
+    int n = 0;
+    char *p = text;
+    while (n < 32) {
+	char *end;
+	field[n++] = strtod(p, &end);
+	if (*end != ',') {
+	    break;
+	}
+	p = end + 1;
+    }
+    for (int i = 0; i < count; i++) {
+	if (column[i] < 0) {
+	    values[i] = fallback[i];
+	} else if (column[i] < n) {
+	    values[i] = field[column[i]];
+	} else {
+	    fprintf(stderr, "%s:%lu: short row\n", path, line);
+	    return false;
+	}
+    }
+    return true;
+}
+
+bool TraceReader::Next( TraceInputs &in )
+{
+    double v[6];
+    if (!Row(v)) {
+	return false;
+    }
+    in.us = (uint64_t) (v[0] * 1000 + 0.5);
+    in.joyx = v[1];
+    in.joyy = v[2];
+    in.vbat = v[3];
+    in.venbl = v[4];
+    in.test = v[5];
+    return true;
+}
+
+bool TraceReader::Next( TraceOutputs &out )
+{
+    double v[4];
+    if (!Row(v)) {
+	return false;
+    }
+    out.ms = v[0];
+    out.state = v[1];
+    out.left = v[2];
+    out.right = v[3];
+    return true;
+}
+
+void WriteInputsHeader( FILE *f )
+{
+    fprintf(f, "ms,joyx,joyy,vbat,venbl,test\n");
+}
+
+void WriteRow( FILE *f, const TraceInputs &in )
+{
+    fprintf(f, "%lu.%03u,%d,%d,%d,%d,%d\n", (unsigned long) (in.us / 1000),
+	    (unsigned) (in.us % 1000), in.joyx, in.joyy, in.vbat, in.venbl, in.test);
+}
+
+void WriteOutputsHeader( FILE *f )
+{
+    fprintf(f, "ms,state,left,right\n");
+}
+
+void WriteRow( FILE *f, const TraceOutputs &out )
+{
+    fprintf(f, "%lu,%d,%d,%d\n", (unsigned long) out.ms,
+	    out.state, out.left, out.right);
+}
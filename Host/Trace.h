@@ -0,0 +1,78 @@
+#pragma once
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Input traces for replay, and what the firmware made of them.  Both
+** are CSV with a header row; columns are found by name and others are
+** ignored, so a CSV from Host/telemrx serves as an input trace too (at
+** its frame rate rather than every tick).
+**
+**   inputs:  ms,joyx,joyy,vbat,venbl[,test]  - A2D counts and the test
+**            button level, from power-on; each row holds until the next.
+**            Times may have a fraction, to the microsecond, so a trace
+**            recorded by cartsim replays exactly.
+**   outputs: ms,state,left,right             - a row per tick where any
+**            of them changed
+*/
+#include <stdint.h>
+#include <stdio.h>
+
+struct TraceInputs {
+    uint64_t us;
+    int joyx, joyy, vbat, venbl;
+    int test;			// pin level, HIGH when released
+
+    // to and from the simulated pins
+    void Present() const;
+    static TraceInputs Capture( uint64_t us );
+};
+
+struct TraceOutputs {
+    uint32_t ms;
+    int state;
+    int left, right;		// servo pulses, 0 while detached
+
+    bool operator==( const TraceOutputs &o ) const
+    {
+	return state == o.state && left == o.left && right == o.right;
+    }
+    bool operator!=( const TraceOutputs &o ) const { return !(*this == o); }
+};
+
+// reads a CSV by column name; missing optional columns read as their
+// default
+class TraceReader {
+public:
+    TraceReader();
+    ~TraceReader();
+
+    // false, with a message on stderr, if the file can't be read or
+    // lacks a column the record needs
+    bool OpenInputs( const char *path );
+    bool OpenOutputs( const char *path );
+
+    // false at the end, or on a malformed row
+    bool Next( TraceInputs &in );
+    bool Next( TraceOutputs &out );
+
+    unsigned long Line() const { return line; }
+
+private:
+    enum { MAX_COLUMNS = 8 };
+    bool Open( const char *path, const char *const *names,
+	       const bool *required, int n );
+    bool Row( double *values );
+
+    FILE *file;
+    const char *path;
+    unsigned long line;
+    int count;			// columns wanted
+    int column[MAX_COLUMNS];	// where each is in the file, -1 if absent
+    double fallback[MAX_COLUMNS];
+};
+
+void WriteInputsHeader( FILE *f );
+void WriteRow( FILE *f, const TraceInputs &in );
+void WriteOutputsHeader( FILE *f );
+void WriteRow( FILE *f, const TraceOutputs &out );
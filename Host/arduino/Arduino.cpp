@@ -0,0 +1,56 @@
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Stand-in Arduino core: pins and virtual time.
+*/
+#include "Arduino.h"
+#include "Sim.h"
+#include "SimState.h"
+
+void pinMode( uint8_t pin, uint8_t mode )
+{
+    pin %= NUM_DIGITAL_PINS;
+    sim.pinMode[pin] = mode;
+    if (mode == INPUT_PULLUP) {
+	sim.digitalOut[pin] = HIGH;
+    }
+}
+
+void digitalWrite( uint8_t pin, uint8_t val )
+{
+    sim.digitalOut[pin % NUM_DIGITAL_PINS] = val ? HIGH : LOW;
+}
+
+int digitalRead( uint8_t pin )
+{
+    pin %= NUM_DIGITAL_PINS;
+    return sim.pinMode[pin] == OUTPUT ? sim.digitalOut[pin] : sim.digitalIn[pin];
+}
+
+int analogRead( uint8_t pin )
+{
+    // a conversion takes 13 ADC clocks at 125 kHz
+    Sim::Advance(104);
+    return sim.analog[pin % NUM_ANALOG_INPUTS];
+}
+
+unsigned long millis()
+{
+    return (unsigned long) (sim.now / 1000);
+}
+
+unsigned long micros()
+{
+    return (unsigned long) sim.now;
+}
+
+void delay( unsigned long ms )
+{
+    Sim::Advance((uint64_t) ms * 1000);
+}
+
+void delayMicroseconds( unsigned int us )
+{
+    Sim::Advance(us);
+}
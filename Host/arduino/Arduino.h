@@ -0,0 +1,48 @@
+#pragma once
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Stand-in for the Arduino core so the sketch in CartBotControl can be
+** compiled unchanged on Linux.  Time is virtual: millis()/micros() only
+** move when the simulator (see Sim.h) advances the clock, or when the
+** firmware itself waits in delay()/delayMicroseconds() or on the I2C bus.
+*/
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include "binary.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH		1
+#define LOW		0
+
+#define INPUT		0x0
+#define OUTPUT		0x1
+#define INPUT_PULLUP	0x2
+
+#define NUM_DIGITAL_PINS	20
+#define NUM_ANALOG_INPUTS	8
+
+void pinMode( uint8_t pin, uint8_t mode );
+void digitalWrite( uint8_t pin, uint8_t val );
+int digitalRead( uint8_t pin );
+int analogRead( uint8_t pin );
+
+unsigned long millis();
+unsigned long micros();
+void delay( unsigned long ms );
+void delayMicroseconds( unsigned int us );
+
+#include "Print.h"
+#include "HardwareSerial.h"
+
+// provided by the sketch
+void setup();
+void loop();
@@ -0,0 +1,206 @@
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** ATmega328P peripherals, as far as the firmware uses them.  Register
+** writes are plain stores, so the configuration is re-read whenever the
+** simulator asks for the next event; events that come due while the I
+** flag is clear stay pending until sei().
+**
+** Timer2: CTC mode with the compare-match A interrupt.
+** ADC: single conversions started with ADSC, or free running; 13 ADC
+** clocks each (25 for the first after ADEN), with the input channel
+** latched when the conversion starts.
+*/
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include "Avr.h"
+#include "Sim.h"
+#include "SimState.h"
+
+volatile uint8_t TCCR2A, TCCR2B, TCNT2, OCR2A, OCR2B, TIMSK2, TIFR2;
+volatile uint8_t SMCR;
+volatile uint8_t ADMUX, ADCSRA, ADCSRB, DIDR0;
+volatile uint16_t ADC;
+
+extern "C" void TIMER2_COMPA_vect(void) __attribute__((weak));
+extern "C" void ADC_vect(void) __attribute__((weak));
+
+static const uint16_t timer2Prescale[8] = { 0, 1, 8, 32, 64, 128, 256, 1024 };
+
+// nanoseconds per CPU clock, times 1000 so 16 MHz stays exact
+#define CLOCK_PS	(1000000000000ULL / F_CPU)
+
+// Event times are kept in picoseconds and, for the checks made on every
+// wake-up, in whole microseconds as well.
+static bool iflag;
+static uint32_t timer2Config;	// the registers Timer2Period() read
+static uint64_t timer2Period;	// picoseconds, 0 when stopped
+static uint64_t timer2Next;	// picoseconds
+static uint64_t timer2NextUs;
+static bool adcEnabled;		// a conversion has run since ADEN was set
+static uint64_t adcDone;	// picoseconds, 0 when idle
+static uint64_t adcDoneUs;
+static uint64_t adcLast;	// end of the previous conversion
+static uint8_t adcMux;		// channel latched at the start
+
+static uint64_t Timer2Period()
+{
+    bool ctc = (TCCR2A & ((1 << WGM21) | (1 << WGM20))) == (1 << WGM21) &&
+	       !(TCCR2B & (1 << WGM22));
+    uint16_t prescale = timer2Prescale[TCCR2B & 7];
+    if (!ctc || !prescale || !(TIMSK2 & (1 << OCIE2A))) {
+	return 0;
+    }
+    return (uint64_t) (OCR2A + 1) * prescale * CLOCK_PS;
+}
+
+static uint64_t AdcClocks( int clocks )
+{
+    // ADPS 0 and 1 both divide by 2
+    uint8_t ps = ADCSRA & 7;
+    return (uint64_t) clocks * (ps ? 1 << ps : 2) * CLOCK_PS;
+}
+
+static bool FreeRunning()
+{
+    return (ADCSRA & (1 << ADATE)) && (ADCSRB & 7) == 0;
+}
+
+static void AdcStart()
+{
+    uint64_t now = sim.now * 1000000ULL;
+    uint64_t start = adcLast > now ? adcLast : now;
+    adcDone = start + AdcClocks(adcEnabled ? 13 : 25);
+    adcDoneUs = adcDone / 1000000ULL;
+    adcMux = ADMUX;
+    adcEnabled = true;
+}
+
+static int AdcSample( uint8_t mux )
+{
+    int value;
+    switch (mux & 0x0F) {
+    case 0x0E:	value = 225;	break;		// 1.1V bandgap
+    case 0x0F:	value = 0;	break;		// GND
+    default:
+	value = (mux & 0x0F) < NUM_ANALOG_INPUTS ? sim.analog[mux & 0x0F] : 0;
+	break;
+    }
+    return (mux & (1 << ADLAR)) ? value << 6 : value;
+}
+
+// vectors in priority order
+static void Dispatch()
+{
+    if ((TIFR2 & (1 << OCF2A)) && (TIMSK2 & (1 << OCIE2A)) &&
+	TIMER2_COMPA_vect) {
+	TIFR2 &= ~(1 << OCF2A);
+	iflag = false;
+	TIMER2_COMPA_vect();
+	iflag = true;
+    }
+    if ((ADCSRA & (1 << ADIF)) && (ADCSRA & (1 << ADIE)) && ADC_vect) {
+	ADCSRA &= ~(1 << ADIF);
+	iflag = false;
+	ADC_vect();
+	iflag = true;
+    }
+}
+
+namespace Avr {
+
+void Reset()
+{
+    TCCR2A = TCCR2B = TCNT2 = OCR2A = OCR2B = TIMSK2 = TIFR2 = 0;
+    SMCR = 0;
+    iflag = true;		// the Arduino core enables interrupts in init()
+    timer2Config = 0;
+    timer2Period = 0;
+    timer2Next = timer2NextUs = 0;
+    ADMUX = ADCSRA = ADCSRB = DIDR0 = 0;
+    ADC = 0;
+    adcEnabled = false;
+    adcDone = adcDoneUs = adcLast = 0;
+}
+
+uint64_t NextEvent()
+{
+    uint32_t config = (uint32_t) TCCR2A | (uint32_t) TCCR2B << 8 |
+		      (uint32_t) OCR2A << 16 | (uint32_t) TIMSK2 << 24;
+    if (config != timer2Config) {
+	timer2Config = config;
+	uint64_t period = Timer2Period();
+	if (period != timer2Period) {
+	    // (re)configured: count from now, as after TCNT2 = 0
+	    timer2Period = period;
+	    timer2Next = period ? sim.now * 1000000ULL + period : 0;
+	    timer2NextUs = timer2Next / 1000000ULL;
+	}
+    }
+    if (!(ADCSRA & (1 << ADEN))) {
+	adcEnabled = false;
+	adcDone = 0;
+    } else if (!adcDone && (ADCSRA & (1 << ADSC))) {
+	AdcStart();
+    }
+
+    uint64_t next = timer2Period ? timer2NextUs : NO_EVENT;
+    if (adcDone && adcDoneUs < next) {
+	next = adcDoneUs;
+    }
+    return next;
+}
+
+void FireEvent()
+{
+    if (timer2Period && timer2NextUs <= sim.now) {
+	timer2Next += timer2Period;
+	timer2NextUs = timer2Next / 1000000ULL;
+	TIFR2 |= (1 << OCF2A);
+    }
+    if (adcDone && adcDoneUs <= sim.now) {
+	ADC = AdcSample(adcMux);
+	ADCSRA |= (1 << ADIF);
+	adcLast = adcDone;
+	adcDone = adcDoneUs = 0;
+	if (FreeRunning()) {
+	    AdcStart();
+	} else {
+	    ADCSRA &= ~(1 << ADSC);
+	}
+    }
+    if (iflag) {
+	Dispatch();
+    }
+}
+
+} // namespace Avr
+
+void cli()
+{
+    iflag = false;
+}
+
+void sei()
+{
+    iflag = true;
+    Dispatch();
+}
+
+void sleep_cpu()
+{
+    if (!(SMCR & (1 << SE))) {
+	return;
+    }
+    uint64_t next = Avr::NextEvent();
+    if (next == Avr::NO_EVENT) {
+	// nothing simulated will wake us; Timer0 overflows every 1024us
+	Sim::Advance(1024);
+    } else {
+	// straight to the one event that wakes us; Sim::Advance() would
+	// ask for the one after as well
+	sim.now = next > sim.now ? next : sim.now + 1;
+	Avr::FireEvent();
+    }
+}
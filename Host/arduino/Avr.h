@@ -0,0 +1,22 @@
+#pragma once
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Simulated ATmega328P peripherals; internal to the stand-in layer.
+*/
+#include <stdint.h>
+
+namespace Avr {
+
+const uint64_t NO_EVENT = ~0ULL;
+
+void Reset();
+
+// virtual time (microseconds) of the next peripheral event
+uint64_t NextEvent();
+
+// raise the events that are due at the current virtual time
+void FireEvent();
+
+} // namespace Avr
@@ -0,0 +1,34 @@
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Stand-in EEPROM library.
+*/
+#include "EEPROM.h"
+#include "Sim.h"
+#include "SimState.h"
+
+// erase + write time of one byte
+#define EEPROM_WRITE_US	3400
+
+EEPROMClass EEPROM;
+
+uint8_t EEPROMClass::read( int idx )
+{
+    return sim.eeprom[idx & E2END];
+}
+
+void EEPROMClass::write( int idx, uint8_t val )
+{
+    Sim::AdvanceTo(sim.eepromBusy);
+    sim.eeprom[idx & E2END] = val;
+    sim.eepromBusy = sim.now + EEPROM_WRITE_US;
+    sim.eepromWrites++;
+}
+
+void EEPROMClass::update( int idx, uint8_t val )
+{
+    if (read(idx) != val) {
+	write(idx, val);
+    }
+}
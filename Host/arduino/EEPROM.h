@@ -0,0 +1,42 @@
+#pragma once
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Stand-in for the Arduino EEPROM library: the ATmega328P's 1K of
+** EEPROM.  The contents survive Sim::Reset(), as they survive a power
+** cycle; Sim::EraseEeprom() gives a factory-fresh part.  A write starts
+** a 3.4ms programming cycle, and a write made while one is running
+** waits for it, as eeprom_write_byte() does.
+*/
+#include <Arduino.h>
+
+#define E2END	0x3FF
+
+class EEPROMClass {
+public:
+    uint8_t read( int idx );
+    void write( int idx, uint8_t val );
+    void update( int idx, uint8_t val );
+    uint16_t length() { return E2END + 1; }
+
+    template <class T> T &get( int idx, T &t )
+    {
+	uint8_t *p = (uint8_t *) &t;
+	for (size_t i = 0; i < sizeof(T); i++) {
+	    p[i] = read(idx + i);
+	}
+	return t;
+    }
+
+    template <class T> const T &put( int idx, const T &t )
+    {
+	const uint8_t *p = (const uint8_t *) &t;
+	for (size_t i = 0; i < sizeof(T); i++) {
+	    update(idx + i, p[i]);
+	}
+	return t;
+    }
+};
+
+extern EEPROMClass EEPROM;
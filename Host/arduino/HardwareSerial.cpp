@@ -0,0 +1,91 @@
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Stand-in hardware serial port.  Once begun, the transmit buffer
+** drains at the baud rate in virtual time, and write() waits for room
+** in it like the interrupt-driven core does.
+*/
+#include "HardwareSerial.h"
+#include "SimState.h"
+
+// microseconds to send one byte, start and stop bits included
+static uint64_t ByteTime()
+{
+    return Serial.baud ? 10000000ULL / Serial.baud : 0;
+}
+
+// bytes written but not yet sent
+static uint64_t TxPending()
+{
+    uint64_t t = ByteTime();
+    if (!t || sim.serialBusy <= sim.now) {
+	return 0;
+    }
+    return (sim.serialBusy - sim.now + t - 1) / t;
+}
+
+HardwareSerial Serial;
+
+HardwareSerial::HardwareSerial()
+  : baud(0)
+{
+    ;
+}
+
+void HardwareSerial::begin( unsigned long rate )
+{
+    baud = rate;
+}
+
+void HardwareSerial::end()
+{
+    baud = 0;
+}
+
+int HardwareSerial::available()
+{
+    return (int) (sim.serialIn.size() - sim.serialInPos);
+}
+
+int HardwareSerial::peek()
+{
+    if (!available()) return -1;
+    return (uint8_t) sim.serialIn[sim.serialInPos];
+}
+
+int HardwareSerial::read()
+{
+    if (!available()) return -1;
+    return (uint8_t) sim.serialIn[sim.serialInPos++];
+}
+
+int HardwareSerial::availableForWrite()
+{
+    uint64_t pending = TxPending();
+    if (pending >= SERIAL_TX_BUFFER_SIZE - 1) {
+	return 0;
+    }
+    return (int) (SERIAL_TX_BUFFER_SIZE - 1 - pending);
+}
+
+void HardwareSerial::flush()
+{
+    Sim::AdvanceTo(sim.serialBusy);
+    if (sim.serialOut) fflush(sim.serialOut);
+}
+
+size_t HardwareSerial::write( uint8_t c )
+{
+    uint64_t t = ByteTime();
+    if (t) {
+	// the buffer is full: wait for the oldest byte to go
+	if (TxPending() >= SERIAL_TX_BUFFER_SIZE - 1) {
+	    Sim::AdvanceTo(sim.serialBusy - (SERIAL_TX_BUFFER_SIZE - 2) * t);
+	}
+	sim.serialBusy = (sim.serialBusy > sim.now ? sim.serialBusy : sim.now)
+			 + t;
+    }
+    if (sim.serialOut) fputc(c, sim.serialOut);
+    return 1;
+}
@@ -0,0 +1,35 @@
+#pragma once
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Stand-in for the Arduino hardware serial port.  Output goes to the
+** stream selected with Sim::SetSerialOutput(); input is whatever the
+** simulator queued with Sim::SerialInput().
+*/
+#include "Print.h"
+
+#define SERIAL_TX_BUFFER_SIZE	64
+#define SERIAL_RX_BUFFER_SIZE	64
+
+class HardwareSerial : public Print {
+public:
+    HardwareSerial();
+
+    void begin( unsigned long baud );
+    void end();
+    int available();
+    int peek();
+    int read();
+    int availableForWrite();
+    void flush();
+
+    virtual size_t write( uint8_t c );
+    using Print::write;
+
+    operator bool() { return true; }
+
+    unsigned long baud;
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,151 @@
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Model of an HD44780 character LCD behind a PCF8574 I2C expander.
+*/
+#include <string.h>
+#include "Hd44780.h"
+
+#define EXEC_TIME	37	// microseconds, most instructions
+#define WRITE_TIME	41	// data writes to DDRAM/CGRAM
+#define CLEAR_TIME	1520	// clear display, return home
+
+static const uint8_t rowOffset[Hd44780::ROWS] = { 0x00, 0x40, 0x14, 0x54 };
+
+Hd44780::Hd44780()
+{
+    Reset();
+}
+
+void Hd44780::Reset()
+{
+    memset(ddram, ' ', sizeof ddram);
+    memset(cgram, 0, sizeof cgram);
+    address = 0;
+    cgSelected = false;
+    increment = true;
+    fourBit = false;
+    highNibble = true;
+    pending = 0;
+    pendingStart = 0;
+    lastEn = false;
+    busyUntil = 0;
+    displayOn = false;
+    backlight = false;
+    instructions = dataWrites = busyViolations = 0;
+}
+
+void Hd44780::Pins( bool rs, bool rw, bool en, uint8_t nibble, uint64_t when )
+{
+    bool falling = lastEn && !en;
+    lastEn = en;
+    if (!falling || rw) {
+	return;
+    }
+
+    if (!fourBit) {
+	// 8-bit interface: only D7..D4 are wired, D3..D0 read as zero
+	Execute(rs, nibble << 4, when);
+    } else if (highNibble) {
+	pending = nibble << 4;
+	pendingStart = when;
+	highNibble = false;
+    } else {
+	highNibble = true;
+	Execute(rs, pending | nibble, pendingStart);
+    }
+}
+
+void Hd44780::Execute( bool rs, uint8_t value, uint64_t start )
+{
+    if (start < busyUntil) {
+	++busyViolations;
+    }
+
+    if (rs) {
+	++dataWrites;
+	if (cgSelected) {
+	    cgram[address & 0x3F] = value & 0x1F;
+	    address = (address + (increment ? 1 : -1)) & 0x3F;
+	} else {
+	    ddram[address & 0x7F] = value;
+	    address = (address + (increment ? 1 : -1)) & 0x7F;
+	}
+	busyUntil = start + WRITE_TIME;
+	return;
+    }
+
+    ++instructions;
+    busyUntil = start + EXEC_TIME;
+    if (value & 0x80) {			// set DDRAM address
+	address = value & 0x7F;
+	cgSelected = false;
+    } else if (value & 0x40) {		// set CGRAM address
+	address = value & 0x3F;
+	cgSelected = true;
+    } else if (value & 0x20) {		// function set
+	fourBit = !(value & 0x10);
+	highNibble = true;
+    } else if (value & 0x10) {		// cursor/display shift
+	;
+    } else if (value & 0x08) {		// display on/off control
+	displayOn = (value & 0x04) != 0;
+    } else if (value & 0x04) {		// entry mode set
+	increment = (value & 0x02) != 0;
+    } else if (value & 0x02) {		// return home
+	address = 0;
+	cgSelected = false;
+	busyUntil = start + CLEAR_TIME;
+    } else if (value & 0x01) {		// clear display
+	memset(ddram, ' ', sizeof ddram);
+	address = 0;
+	cgSelected = false;
+	increment = true;
+	busyUntil = start + CLEAR_TIME;
+    }
+}
+
+char Hd44780::At( int row, int col ) const
+{
+    return ddram[(rowOffset[row] + col) & 0x7F];
+}
+
+void Hd44780::Row( int row, char *buf ) const
+{
+    for (int col = 0; col < COLS; col++) {
+	buf[col] = At(row, col);
+    }
+    buf[COLS] = '\0';
+}
+
+const uint8_t *Hd44780::Glyph( int slot ) const
+{
+    return &cgram[(slot & 7) * 8];
+}
+
+////////////////////////////////////////
+
+LcdBackpack::LcdBackpack( uint8_t en, uint8_t rw, uint8_t rs,
+			  uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7,
+			  uint8_t bl )
+  : enMask(1 << en), rwMask(1 << rw), rsMask(1 << rs), blMask(1 << bl)
+{
+    dShift[0] = d4;
+    dShift[1] = d5;
+    dShift[2] = d6;
+    dShift[3] = d7;
+}
+
+void LcdBackpack::Receive( uint8_t data, uint64_t when )
+{
+    uint8_t nibble = 0;
+    for (int i = 0; i < 4; i++) {
+	if (data & (1 << dShift[i])) {
+	    nibble |= 1 << i;
+	}
+    }
+    lcd.backlight = (data & blMask) != 0;
+    lcd.Pins((data & rsMask) != 0, (data & rwMask) != 0, (data & enMask) != 0,
+	     nibble, when);
+}
@@ -0,0 +1,69 @@
+#pragma once
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Model of an HD44780 character LCD driven in 4-bit mode through a
+** PCF8574 I2C expander.  Nibbles are latched on the falling edge of E,
+** exactly as the real controller does, so any sequence of expander
+** writes - from the stock library or a custom transport - is decoded
+** the same way the glass would show it.  Instructions that arrive while
+** the controller is still busy with the previous one are counted.
+*/
+#include <stdint.h>
+#include "Sim.h"
+
+class Hd44780 {
+public:
+    Hd44780();
+
+    void Reset();
+
+    // one state of the bus pins; E falling edge latches the data nibble
+    void Pins( bool rs, bool rw, bool en, uint8_t nibble, uint64_t when );
+
+    char At( int row, int col ) const;
+    void Row( int row, char *buf ) const;	// LCD_COLS chars + NUL
+    const uint8_t *Glyph( int slot ) const;	// 8 rows of CGRAM
+
+    bool displayOn;
+    bool backlight;
+
+    unsigned long instructions;
+    unsigned long dataWrites;
+    unsigned long busyViolations;
+
+    static const int ROWS = 4;
+    static const int COLS = 20;
+
+private:
+    void Execute( bool rs, uint8_t value, uint64_t start );
+
+    uint8_t ddram[128];
+    uint8_t cgram[64];
+    uint8_t address;
+    bool cgSelected;
+    bool increment;
+    bool fourBit;
+    bool highNibble;
+    uint8_t pending;
+    uint64_t pendingStart;
+    bool lastEn;
+    uint64_t busyUntil;
+};
+
+// the PCF8574 backpack: maps expander bits onto the controller pins
+class LcdBackpack : public Sim::I2cDevice {
+public:
+    LcdBackpack( uint8_t en, uint8_t rw, uint8_t rs,
+		 uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7,
+		 uint8_t bl );
+
+    virtual void Receive( uint8_t data, uint64_t when );
+
+    Hd44780 lcd;
+
+private:
+    uint8_t enMask, rwMask, rsMask, blMask;
+    uint8_t dShift[4];
+};
@@ -0,0 +1,180 @@
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Stand-in for NewLiquidCrystal's LCD base class.
+*/
+#include "LCD.h"
+
+LCD::LCD()
+  : _displayfunction(0), _displaycontrol(0), _displaymode(0),
+    _numlines(1), _cols(16), _polarity(POSITIVE)
+{
+    ;
+}
+
+void LCD::begin( uint8_t cols, uint8_t lines, uint8_t dotsize )
+{
+    if (lines > 1) {
+	_displayfunction |= LCD_2LINE;
+    }
+    _numlines = lines;
+    _cols = cols;
+    if ((dotsize != LCD_5x8DOTS) && (lines == 1)) {
+	_displayfunction |= LCD_5x10DOTS;
+    }
+
+    delay(100);
+
+    // HD44780 datasheet, figure 24: initializing by instruction
+    send(0x03, FOUR_BITS);
+    delayMicroseconds(4500);
+    send(0x03, FOUR_BITS);
+    delayMicroseconds(4500);
+    send(0x03, FOUR_BITS);
+    delayMicroseconds(150);
+    send(0x02, FOUR_BITS);
+
+    command(LCD_FUNCTIONSET | _displayfunction);
+    delayMicroseconds(60);
+
+    _displaycontrol = LCD_DISPLAYON | LCD_CURSOROFF | LCD_BLINKOFF;
+    display();
+    clear();
+
+    _displaymode = LCD_ENTRYLEFT | LCD_ENTRYSHIFTDECREMENT;
+    command(LCD_ENTRYMODESET | _displaymode);
+
+    backlight();
+}
+
+void LCD::clear()
+{
+    command(LCD_CLEARDISPLAY);
+    delayMicroseconds(HOME_CLEAR_EXEC);
+}
+
+void LCD::home()
+{
+    command(LCD_RETURNHOME);
+    delayMicroseconds(HOME_CLEAR_EXEC);
+}
+
+void LCD::setCursor( uint8_t col, uint8_t row )
+{
+    const uint8_t row_offsetsDef[] = { 0x00, 0x40, 0x14, 0x54 };
+    const uint8_t row_offsetsLarge[] = { 0x00, 0x40, 0x10, 0x50 };
+
+    if (row >= _numlines) {
+	row = _numlines - 1;
+    }
+    if (_cols == 16 && _numlines == 4) {
+	command(LCD_SETDDRAMADDR | (col + row_offsetsLarge[row]));
+    } else {
+	command(LCD_SETDDRAMADDR | (col + row_offsetsDef[row]));
+    }
+}
+
+void LCD::noDisplay()
+{
+    _displaycontrol &= ~LCD_DISPLAYON;
+    command(LCD_DISPLAYCONTROL | _displaycontrol);
+}
+
+void LCD::display()
+{
+    _displaycontrol |= LCD_DISPLAYON;
+    command(LCD_DISPLAYCONTROL | _displaycontrol);
+}
+
+void LCD::noCursor()
+{
+    _displaycontrol &= ~LCD_CURSORON;
+    command(LCD_DISPLAYCONTROL | _displaycontrol);
+}
+
+void LCD::cursor()
+{
+    _displaycontrol |= LCD_CURSORON;
+    command(LCD_DISPLAYCONTROL | _displaycontrol);
+}
+
+void LCD::noBlink()
+{
+    _displaycontrol &= ~LCD_BLINKON;
+    command(LCD_DISPLAYCONTROL | _displaycontrol);
+}
+
+void LCD::blink()
+{
+    _displaycontrol |= LCD_BLINKON;
+    command(LCD_DISPLAYCONTROL | _displaycontrol);
+}
+
+void LCD::leftToRight()
+{
+    _displaymode |= LCD_ENTRYLEFT;
+    command(LCD_ENTRYMODESET | _displaymode);
+}
+
+void LCD::rightToLeft()
+{
+    _displaymode &= ~LCD_ENTRYLEFT;
+    command(LCD_ENTRYMODESET | _displaymode);
+}
+
+void LCD::autoscroll()
+{
+    _displaymode |= LCD_ENTRYSHIFTINCREMENT;
+    command(LCD_ENTRYMODESET | _displaymode);
+}
+
+void LCD::noAutoscroll()
+{
+    _displaymode &= ~LCD_ENTRYSHIFTINCREMENT;
+    command(LCD_ENTRYMODESET | _displaymode);
+}
+
+void LCD::createChar( uint8_t location, uint8_t charmap[] )
+{
+    location &= 0x7;
+    command(LCD_SETCGRAMADDR | (location << 3));
+    delayMicroseconds(30);
+    for (uint8_t i = 0; i < 8; i++) {
+	write(charmap[i]);
+	delayMicroseconds(40);
+    }
+}
+
+void LCD::backlight()
+{
+    setBacklight(255);
+}
+
+void LCD::noBacklight()
+{
+    setBacklight(0);
+}
+
+void LCD::on()
+{
+    display();
+    backlight();
+}
+
+void LCD::off()
+{
+    noBacklight();
+    noDisplay();
+}
+
+size_t LCD::write( uint8_t value )
+{
+    send(value, LCD_DATA);
+    return 1;
+}
+
+void LCD::command( uint8_t value )
+{
+    send(value, COMMAND);
+}
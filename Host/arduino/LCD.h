@@ -0,0 +1,97 @@
+#pragma once
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Stand-in for the LCD base class of F Malpartida's NewLiquidCrystal
+** library.  Only the parts of the API that CartBot uses are provided;
+** the command encoding and delays follow the original library.
+*/
+#include <Arduino.h>
+
+// commands
+#define LCD_CLEARDISPLAY	0x01
+#define LCD_RETURNHOME		0x02
+#define LCD_ENTRYMODESET	0x04
+#define LCD_DISPLAYCONTROL	0x08
+#define LCD_CURSORSHIFT		0x10
+#define LCD_FUNCTIONSET		0x20
+#define LCD_SETCGRAMADDR	0x40
+#define LCD_SETDDRAMADDR	0x80
+
+// flags for display entry mode
+#define LCD_ENTRYRIGHT		0x00
+#define LCD_ENTRYLEFT		0x02
+#define LCD_ENTRYSHIFTINCREMENT	0x01
+#define LCD_ENTRYSHIFTDECREMENT	0x00
+
+// flags for display on/off and cursor control
+#define LCD_DISPLAYON		0x04
+#define LCD_DISPLAYOFF		0x00
+#define LCD_CURSORON		0x02
+#define LCD_CURSOROFF		0x00
+#define LCD_BLINKON		0x01
+#define LCD_BLINKOFF		0x00
+
+// flags for function set
+#define LCD_8BITMODE		0x10
+#define LCD_4BITMODE		0x00
+#define LCD_2LINE		0x08
+#define LCD_1LINE		0x00
+#define LCD_5x10DOTS		0x04
+#define LCD_5x8DOTS		0x00
+
+// send() modes
+#define COMMAND			0
+#define LCD_DATA		1
+#define FOUR_BITS		2
+
+// execution times in microseconds
+#define HOME_CLEAR_EXEC		2000
+
+typedef enum { POSITIVE, NEGATIVE } t_backlighPol;
+
+class LCD : public Print {
+public:
+    LCD();
+
+    virtual void begin( uint8_t cols, uint8_t rows, uint8_t charsize = LCD_5x8DOTS );
+
+    void clear();
+    void home();
+    void noDisplay();
+    void display();
+    void noBlink();
+    void blink();
+    void noCursor();
+    void cursor();
+    void leftToRight();
+    void rightToLeft();
+    void autoscroll();
+    void noAutoscroll();
+    void createChar( uint8_t location, uint8_t charmap[] );
+    void setCursor( uint8_t col, uint8_t row );
+    void backlight();
+    void noBacklight();
+    void on();
+    void off();
+
+    virtual void setBacklightPin( uint8_t value, t_backlighPol pol ) { }
+    virtual void setBacklight( uint8_t value ) { }
+
+    virtual size_t write( uint8_t value );
+    using Print::write;
+
+    // public in the library too, for features it does not cover
+    void command( uint8_t value );
+
+protected:
+    virtual void send( uint8_t value, uint8_t mode ) = 0;
+
+    uint8_t _displayfunction;
+    uint8_t _displaycontrol;
+    uint8_t _displaymode;
+    uint8_t _numlines;
+    uint8_t _cols;
+    t_backlighPol _polarity;
+};
@@ -0,0 +1,94 @@
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Stand-in for NewLiquidCrystal's LiquidCrystal_I2C.
+*/
+#include "LiquidCrystal_I2C.h"
+
+LiquidCrystal_I2C::LiquidCrystal_I2C( uint8_t lcd_Addr, uint8_t En, uint8_t Rw,
+				      uint8_t Rs, uint8_t d4, uint8_t d5,
+				      uint8_t d6, uint8_t d7,
+				      uint8_t backlighPin, t_backlighPol pol )
+  : _Addr(lcd_Addr), _backlightPinMask(0), _backlightStsMask(0),
+    _En(1 << En), _Rw(1 << Rw), _Rs(1 << Rs)
+{
+    _data_pins[0] = 1 << d4;
+    _data_pins[1] = 1 << d5;
+    _data_pins[2] = 1 << d6;
+    _data_pins[3] = 1 << d7;
+    _displayfunction = LCD_4BITMODE | LCD_1LINE | LCD_5x8DOTS;
+
+    // the original writes the expander here, before Wire is running,
+    // which has no effect; just remember the pin and polarity
+    _backlightPinMask = 1 << backlighPin;
+    _polarity = pol;
+}
+
+void LiquidCrystal_I2C::begin( uint8_t cols, uint8_t lines, uint8_t dotsize )
+{
+    Wire.begin();
+    _displayfunction = LCD_4BITMODE | LCD_1LINE | LCD_5x8DOTS;
+    expanderWrite(0);
+    LCD::begin(cols, lines, dotsize);
+}
+
+void LiquidCrystal_I2C::setBacklightPin( uint8_t value, t_backlighPol pol )
+{
+    _backlightPinMask = 1 << value;
+    _polarity = pol;
+    setBacklight(0);
+}
+
+void LiquidCrystal_I2C::setBacklight( uint8_t value )
+{
+    if (_backlightPinMask) {
+	if ((_polarity == POSITIVE && value > 0) ||
+	    (_polarity == NEGATIVE && value == 0)) {
+	    _backlightStsMask = _backlightPinMask;
+	} else {
+	    _backlightStsMask = 0;
+	}
+	expanderWrite(_backlightStsMask);
+    }
+}
+
+void LiquidCrystal_I2C::send( uint8_t value, uint8_t mode )
+{
+    if (mode == FOUR_BITS) {
+	write4bits(value & 0x0F, COMMAND);
+    } else {
+	write4bits(value >> 4, mode);
+	write4bits(value & 0x0F, mode);
+    }
+}
+
+void LiquidCrystal_I2C::write4bits( uint8_t value, uint8_t mode )
+{
+    uint8_t pinMapValue = 0;
+
+    for (uint8_t i = 0; i < 4; i++) {
+	if (value & 0x1) {
+	    pinMapValue |= _data_pins[i];
+	}
+	value >>= 1;
+    }
+    if (mode == LCD_DATA) {
+	mode = _Rs;
+    }
+    pinMapValue |= mode | _backlightStsMask;
+    pulseEnable(pinMapValue);
+}
+
+void LiquidCrystal_I2C::pulseEnable( uint8_t data )
+{
+    expanderWrite(data | _En);
+    expanderWrite(data & ~_En);
+}
+
+void LiquidCrystal_I2C::expanderWrite( uint8_t value )
+{
+    Wire.beginTransmission(_Addr);
+    Wire.write(value);
+    Wire.endTransmission();
+}
@@ -0,0 +1,38 @@
+#pragma once
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Stand-in for NewLiquidCrystal's LiquidCrystal_I2C.  Like the original,
+** every nibble goes out as two separate one-byte Wire transmissions (enable
+** high, enable low) to the PCF8574 expander, so bus traffic seen by the
+** simulated display matches what the real library puts on the wire.
+*/
+#include <Arduino.h>
+#include <Wire.h>
+#include "LCD.h"
+
+class LiquidCrystal_I2C : public LCD {
+public:
+    LiquidCrystal_I2C( uint8_t lcd_Addr, uint8_t En, uint8_t Rw, uint8_t Rs,
+		       uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7,
+		       uint8_t backlighPin, t_backlighPol pol );
+
+    virtual void begin( uint8_t cols, uint8_t rows, uint8_t charsize = LCD_5x8DOTS );
+    virtual void send( uint8_t value, uint8_t mode );
+    virtual void setBacklightPin( uint8_t value, t_backlighPol pol );
+    virtual void setBacklight( uint8_t value );
+
+private:
+    void expanderWrite( uint8_t value );
+    void write4bits( uint8_t value, uint8_t mode );
+    void pulseEnable( uint8_t data );
+
+    uint8_t _Addr;
+    uint8_t _backlightPinMask;
+    uint8_t _backlightStsMask;
+    uint8_t _En;
+    uint8_t _Rw;
+    uint8_t _Rs;
+    uint8_t _data_pins[4];
+};
@@ -0,0 +1,81 @@
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Stand-in Servo library.
+*/
+#include "Servo.h"
+#include "Sim.h"
+
+Servo::Servo()
+  : pin(-1), min(MIN_PULSE_WIDTH), max(MAX_PULSE_WIDTH),
+    pulse(DEFAULT_PULSE_WIDTH), isAttached(false)
+{
+    ;
+}
+
+Servo::~Servo()
+{
+    ;
+}
+
+uint8_t Servo::attach( int p )
+{
+    return attach(p, MIN_PULSE_WIDTH, MAX_PULSE_WIDTH);
+}
+
+uint8_t Servo::attach( int p, int lo, int hi )
+{
+    pin = p;
+    min = lo;
+    max = hi;
+    isAttached = true;
+    pinMode(pin, OUTPUT);
+    Sim::SetServoPulse(pin, pulse);
+    return 0;
+}
+
+void Servo::detach()
+{
+    if (isAttached) {
+	Sim::SetServoPulse(pin, 0);
+    }
+    isAttached = false;
+}
+
+void Servo::write( int value )
+{
+    if (value < MIN_PULSE_WIDTH) {
+	if (value < 0) value = 0;
+	if (value > 180) value = 180;
+	value = min + (long) (max - min) * value / 180;
+    }
+    writeMicroseconds(value);
+}
+
+void Servo::writeMicroseconds( int value )
+{
+    // clamped to the limits given to attach(), as the AVR library does;
+    // before the first attach() those are the library defaults
+    if (value < min) value = min;
+    if (value > max) value = max;
+    pulse = value;
+    if (isAttached) {
+	Sim::SetServoPulse(pin, pulse);
+    }
+}
+
+int Servo::read()
+{
+    return (int) ((long) (readMicroseconds() - min) * 180 / (max - min));
+}
+
+int Servo::readMicroseconds()
+{
+    return pulse;
+}
+
+bool Servo::attached()
+{
+    return isAttached;
+}
@@ -0,0 +1,36 @@
+#pragma once
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Stand-in for the Arduino Servo library.  Pulse widths are clamped the
+** same way the AVR library clamps them, and the pulse currently being
+** generated on each pin can be read back with Sim::GetServoPulse().
+*/
+#include <Arduino.h>
+
+#define MIN_PULSE_WIDTH		544
+#define MAX_PULSE_WIDTH		2400
+#define DEFAULT_PULSE_WIDTH	1500
+
+class Servo {
+public:
+    Servo();
+    ~Servo();
+
+    uint8_t attach( int pin );
+    uint8_t attach( int pin, int min, int max );
+    void detach();
+    void write( int value );
+    void writeMicroseconds( int value );
+    int read();
+    int readMicroseconds();
+    bool attached();
+
+private:
+    int pin;
+    int min;
+    int max;
+    int pulse;
+    bool isAttached;
+};
@@ -0,0 +1,202 @@
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Simulator state shared by the stand-in Arduino layer.
+*/
+#include <string.h>
+#include <string>
+#include "Arduino.h"
+#include "Avr.h"
+#include "Hd44780.h"
+#include "Sim.h"
+#include "SimState.h"
+
+SimState sim;
+
+static struct SimInit {
+    SimInit() { Sim::EraseEeprom(); Sim::Reset(); }
+} simInit;
+
+namespace Sim {
+
+void Reset()
+{
+    delete sim.backpack;
+    sim.backpack = NULL;
+
+    sim.now = 0;
+    Avr::Reset();
+    memset(sim.analog, 0, sizeof sim.analog);
+    for (int i = 0; i < NUM_DIGITAL_PINS; i++) {
+	sim.digitalIn[i] = HIGH;
+	sim.digitalOut[i] = LOW;
+	sim.pinMode[i] = INPUT;
+	sim.servo[i] = 0;
+	sim.servoChanged[i] = 0;
+    }
+    sim.serialOut = NULL;
+    sim.serialIn.clear();
+    sim.serialInPos = 0;
+    sim.serialBusy = 0;
+    memset(sim.i2c, 0, sizeof sim.i2c);
+    SetI2cClock(100000);
+    memset(&sim.i2cStats, 0, sizeof sim.i2cStats);
+    sim.eepromBusy = 0;
+}
+
+uint64_t Now()
+{
+    return sim.now;
+}
+
+void Advance( uint64_t us )
+{
+    uint64_t target = sim.now + us;
+
+    // stop at each peripheral event on the way so its interrupt runs at
+    // the right virtual time
+    for (;;) {
+	uint64_t next = Avr::NextEvent();
+	if (next > target) {
+	    break;
+	}
+	if (next > sim.now) {
+	    sim.now = next;
+	}
+	Avr::FireEvent();
+    }
+    sim.now = target;
+}
+
+void AdvanceTo( uint64_t us )
+{
+    if (us > sim.now) {
+	Advance(us - sim.now);
+    }
+}
+
+void SetAnalog( uint8_t pin, int value )
+{
+    if (value < 0) value = 0;
+    if (value > 1023) value = 1023;
+    sim.analog[pin % NUM_ANALOG_INPUTS] = value;
+}
+
+void SetDigital( uint8_t pin, int level )
+{
+    sim.digitalIn[pin % NUM_DIGITAL_PINS] = level ? HIGH : LOW;
+}
+
+int GetAnalog( uint8_t pin )
+{
+    return sim.analog[pin % NUM_ANALOG_INPUTS];
+}
+
+int GetInput( uint8_t pin )
+{
+    return sim.digitalIn[pin % NUM_DIGITAL_PINS];
+}
+
+int GetDigital( uint8_t pin )
+{
+    return sim.digitalOut[pin % NUM_DIGITAL_PINS];
+}
+
+int GetServoPulse( uint8_t pin )
+{
+    return sim.servo[pin % NUM_DIGITAL_PINS];
+}
+
+uint64_t GetServoChanged( uint8_t pin )
+{
+    return sim.servoChanged[pin % NUM_DIGITAL_PINS];
+}
+
+void SetServoPulse( uint8_t pin, int us )
+{
+    pin %= NUM_DIGITAL_PINS;
+    if (sim.servo[pin] != us) {
+	sim.servo[pin] = us;
+	sim.servoChanged[pin] = sim.now;
+    }
+}
+
+void SetSerialOutput( FILE *f )
+{
+    sim.serialOut = f;
+}
+
+void SerialInput( const char *text )
+{
+    sim.serialIn.erase(0, sim.serialInPos);
+    sim.serialInPos = 0;
+    sim.serialIn += text;
+}
+
+void AttachI2c( uint8_t address, I2cDevice *device )
+{
+    sim.i2c[address & 0x7F] = device;
+}
+
+I2cDevice *FindI2c( uint8_t address )
+{
+    return sim.i2c[address & 0x7F];
+}
+
+void SetI2cClock( uint32_t hz )
+{
+    sim.i2cClock = hz;
+    sim.i2cBitNs = 1000000000u / hz;
+}
+
+uint32_t GetI2cClock()
+{
+    return sim.i2cClock;
+}
+
+uint32_t GetI2cBitNs()
+{
+    return sim.i2cBitNs;
+}
+
+const I2cStats &GetI2cStats()
+{
+    return sim.i2cStats;
+}
+
+void ChargeI2c( unsigned long bytes, uint64_t micros )
+{
+    sim.i2cStats.transmissions++;
+    sim.i2cStats.bytes += bytes;
+    sim.i2cStats.busMicros += micros;
+}
+
+Hd44780 &AttachLcd( uint8_t address, uint8_t en, uint8_t rw, uint8_t rs,
+		    uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7,
+		    uint8_t backlight )
+{
+    delete sim.backpack;
+    sim.backpack = new LcdBackpack(en, rw, rs, d4, d5, d6, d7, backlight);
+    AttachI2c(address, sim.backpack);
+    return sim.backpack->lcd;
+}
+
+Hd44780 *GetLcd()
+{
+    return sim.backpack ? &sim.backpack->lcd : NULL;
+}
+
+void EraseEeprom()
+{
+    memset(sim.eeprom, 0xFF, sizeof sim.eeprom);
+    sim.eepromBusy = 0;
+    sim.eepromWrites = 0;
+}
+
+unsigned long GetEepromWrites()
+{
+    return sim.eepromWrites;
+}
+
+} // namespace Sim
@@ -0,0 +1,75 @@
+#pragma once
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Simulator control interface for the host stand-in Arduino layer:
+** the virtual clock, input pins seen by the firmware, outputs produced
+** by it, and the devices hanging off the I2C bus.
+*/
+#include <stdint.h>
+#include <stdio.h>
+
+class Hd44780;
+
+namespace Sim {
+
+// a device on the simulated I2C bus; bytes arrive with their bus time
+class I2cDevice {
+public:
+    virtual ~I2cDevice() {}
+    virtual void Receive( uint8_t data, uint64_t when ) = 0;
+};
+
+struct I2cStats {
+    unsigned long transmissions;	// Wire.endTransmission() calls
+    unsigned long bytes;		// bytes on the bus incl. address
+    uint64_t busMicros;			// time spent clocking them out
+};
+
+// return everything to the power-on state (clock at zero, pins idle,
+// no devices attached)
+void Reset();
+
+// virtual clock, in microseconds since Reset()
+uint64_t Now();
+void Advance( uint64_t us );
+void AdvanceTo( uint64_t us );
+
+// inputs seen by analogRead()/digitalRead()
+void SetAnalog( uint8_t pin, int value );
+void SetDigital( uint8_t pin, int level );
+int GetAnalog( uint8_t pin );		// as last set
+int GetInput( uint8_t pin );
+
+// outputs driven by the firmware
+int GetDigital( uint8_t pin );
+int GetServoPulse( uint8_t pin );	// microseconds, 0 if not attached
+uint64_t GetServoChanged( uint8_t pin );	// Now() when it last changed
+void SetServoPulse( uint8_t pin, int us );
+
+// serial port; output defaults to nowhere
+void SetSerialOutput( FILE *f );
+void SerialInput( const char *text );
+
+// I2C bus
+void AttachI2c( uint8_t address, I2cDevice *device );
+I2cDevice *FindI2c( uint8_t address );
+void SetI2cClock( uint32_t hz );
+uint32_t GetI2cClock();
+uint32_t GetI2cBitNs();
+const I2cStats &GetI2cStats();
+void ChargeI2c( unsigned long bytes, uint64_t micros );
+
+// EEPROM; unlike everything else it keeps its contents across Reset()
+void EraseEeprom();
+unsigned long GetEepromWrites();	// bytes programmed since erased
+
+// the character LCD behind a PCF8574 backpack, wired up with the given
+// expander bit numbers; the model lives until the next Reset()
+Hd44780 &AttachLcd( uint8_t address, uint8_t en, uint8_t rw, uint8_t rs,
+		    uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7,
+		    uint8_t backlight );
+Hd44780 *GetLcd();
+
+} // namespace Sim
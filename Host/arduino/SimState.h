@@ -0,0 +1,42 @@
+#pragma once
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Internal state of the stand-in Arduino layer.  Not for use by the
+** firmware or by simulator front ends; those go through Sim.h.
+*/
+#include <stdio.h>
+#include <string>
+#include "Arduino.h"
+#include "Sim.h"
+
+class LcdBackpack;
+
+struct SimState {
+    uint64_t now;			// virtual time, microseconds
+
+    int analog[NUM_ANALOG_INPUTS];
+    uint8_t digitalIn[NUM_DIGITAL_PINS];
+    uint8_t digitalOut[NUM_DIGITAL_PINS];
+    uint8_t pinMode[NUM_DIGITAL_PINS];
+    int servo[NUM_DIGITAL_PINS];
+    uint64_t servoChanged[NUM_DIGITAL_PINS];
+
+    FILE *serialOut;
+    std::string serialIn;
+    size_t serialInPos;
+    uint64_t serialBusy;		// when the last byte written is sent
+
+    Sim::I2cDevice *i2c[128];
+    uint32_t i2cClock;
+    uint32_t i2cBitNs;
+    Sim::I2cStats i2cStats;
+    LcdBackpack *backpack;
+
+    uint8_t eeprom[1024];		// kept across Reset()
+    uint64_t eepromBusy;		// end of the write in progress
+    unsigned long eepromWrites;
+};
+
+extern SimState sim;
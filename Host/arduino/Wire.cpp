@@ -0,0 +1,87 @@
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Stand-in Wire library.  A transmission costs a start condition, the
+** address byte, the data bytes (9 clocks each with the ACK) and a stop
+** condition, plus the fixed software overhead of the interrupt-driven
+** AVR TWI driver.  The virtual clock advances by that much.
+*/
+#include "Wire.h"
+#include "Sim.h"
+
+#define TWI_OVERHEAD_US	12	// driver setup/teardown per transmission
+
+TwoWire Wire;
+
+TwoWire::TwoWire()
+  : txAddress(0), txLength(0), transmitting(false)
+{
+    ;
+}
+
+void TwoWire::begin()
+{
+    ;
+}
+
+void TwoWire::end()
+{
+    ;
+}
+
+void TwoWire::setClock( uint32_t clock )
+{
+    Sim::SetI2cClock(clock);
+}
+
+void TwoWire::beginTransmission( uint8_t address )
+{
+    transmitting = true;
+    txAddress = address;
+    txLength = 0;
+}
+
+size_t TwoWire::write( uint8_t data )
+{
+    if (!transmitting || txLength >= BUFFER_LENGTH) {
+	return 0;
+    }
+    txBuffer[txLength++] = data;
+    return 1;
+}
+
+size_t TwoWire::write( const uint8_t *data, size_t quantity )
+{
+    for (size_t i = 0; i < quantity; i++) {
+	if (!write(data[i])) return i;
+    }
+    return quantity;
+}
+
+uint8_t TwoWire::endTransmission( bool sendStop )
+{
+    transmitting = false;
+
+    // bit times in nanoseconds so 400 kHz stays exact
+    uint64_t bitNs = Sim::GetI2cBitNs();
+    uint64_t start = Sim::Now() * 1000 + TWI_OVERHEAD_US * 1000ull;
+    uint64_t t = start + bitNs;		// start condition
+
+    Sim::I2cDevice *device = Sim::FindI2c(txAddress);
+    t += 9 * bitNs;			// address + ACK
+    if (device) {
+	for (uint8_t i = 0; i < txLength; i++) {
+	    t += 9 * bitNs;
+	    device->Receive(txBuffer[i], t / 1000);
+	}
+    }
+    t += bitNs;				// stop condition
+
+    unsigned long bytes = 1 + (device ? txLength : 0);
+    uint64_t busNs = t - start;
+    Sim::ChargeI2c(bytes, busNs / 1000);
+    Sim::AdvanceTo((t + 999) / 1000);
+
+    return device ? 0 : 2;		// 2 == NACK on address
+}
@@ -0,0 +1,36 @@
+#pragma once
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Stand-in for the Arduino Wire (TWI master) library.  Each transmission
+** is delivered byte by byte to the device attached at that address and
+** costs virtual bus time according to the selected I2C clock.
+*/
+#include <Arduino.h>
+
+#define BUFFER_LENGTH	32
+
+class TwoWire : public Print {
+public:
+    TwoWire();
+
+    void begin();
+    void end();
+    void setClock( uint32_t clock );
+    void beginTransmission( uint8_t address );
+    void beginTransmission( int address ) { beginTransmission((uint8_t) address); }
+    uint8_t endTransmission( bool sendStop = true );
+
+    virtual size_t write( uint8_t data );
+    virtual size_t write( const uint8_t *data, size_t quantity );
+    using Print::write;
+
+private:
+    uint8_t txAddress;
+    uint8_t txBuffer[BUFFER_LENGTH];
+    uint8_t txLength;
+    bool transmitting;
+};
+
+extern TwoWire Wire;
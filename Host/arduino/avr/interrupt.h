@@ -0,0 +1,17 @@
+#pragma once
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Stand-in for <avr/interrupt.h>.  ISR(vector) defines an ordinary
+** function the simulator calls when the peripheral event fires; cli()
+** and sei() hold off and release delivery the way the I flag does.
+*/
+#include <avr/io.h>
+
+#define ISR(vector, ...) \
+    extern "C" void vector(void); \
+    extern "C" void vector(void)
+
+void cli();
+void sei();
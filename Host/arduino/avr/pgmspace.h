@@ -0,0 +1,23 @@
+#pragma once
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Stand-in for <avr/pgmspace.h>.  The host has one address space, so
+** PROGMEM data is ordinary const data and the _P functions are the
+** plain ones.
+*/
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P		const char *
+#define PSTR(s)		(s)
+
+#define pgm_read_byte(addr)	(*(const uint8_t *) (addr))
+#define pgm_read_word(addr)	(*(const uint16_t *) (addr))
+
+#define memcpy_P	memcpy
+#define memcmp_P	memcmp
+#define strcpy_P	strcpy
+#define strlen_P	strlen
@@ -0,0 +1,24 @@
+#pragma once
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Stand-in for <avr/sleep.h>.  Sleeping skips the virtual clock ahead to
+** the next simulated interrupt.
+*/
+#include <avr/io.h>
+
+#define SLEEP_MODE_IDLE		(0)
+#define SLEEP_MODE_ADC		(1 << SM0)
+#define SLEEP_MODE_PWR_DOWN	(1 << SM1)
+#define SLEEP_MODE_PWR_SAVE	((1 << SM0) | (1 << SM1))
+
+#define set_sleep_mode(mode) \
+    (SMCR = (SMCR & ~((1 << SM0) | (1 << SM1) | (1 << SM2))) | (mode))
+#define sleep_enable()	(SMCR |= (1 << SE))
+#define sleep_disable()	(SMCR &= ~(1 << SE))
+
+void sleep_cpu();
+
+#define sleep_mode() \
+    do { sleep_enable(); sleep_cpu(); sleep_disable(); } while (0)
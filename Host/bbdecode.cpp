@@ -0,0 +1,86 @@
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Expands a black box dump, as printed by the sketch's 'b' serial
+** command, into CSV: one row per sample, the last one at time 0.
+** Anything before the dump (a serial log, say) is skipped.
+**
+** usage: bbdecode < dump > blackbox.csv
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "../CartBotControl/BlackBox.h"
+
+static void Fail( const char *why )
+{
+    fprintf(stderr, "bbdecode: %s\n", why);
+    exit(1);
+}
+
+int main()
+{
+    char line[256];
+    int period = 0;
+    unsigned long samples = 0;
+
+    while (fgets(line, sizeof line, stdin)) {
+	if (sscanf(line, "blackbox %d ms %lu", &period, &samples) == 2) {
+	    break;
+	}
+    }
+    if (!period) {
+	Fail("no black box dump in the input");
+    }
+
+    BlackBoxSample s;
+    if (!fgets(line, sizeof line, stdin) ||
+	sscanf(line, "base %hd %hd %hd %hd %hd %hd %hd",
+	       &s.v[0], &s.v[1], &s.v[2], &s.v[3], &s.v[4], &s.v[5],
+	       &s.v[6]) != BB_FIELDS) {
+	Fail("bad base line");
+    }
+
+    std::vector<uint8_t> bytes;
+    bool ended = false;
+    while (fgets(line, sizeof line, stdin)) {
+	if (!strncmp(line, "end", 3)) {
+	    ended = true;
+	    break;
+	}
+	for (char *p = line; p[0] && p[1] && p[0] != '\r' && p[0] != '\n';
+	     p += 2) {
+	    char hex[3] = { p[0], p[1], '\0' };
+	    bytes.push_back((uint8_t) strtoul(hex, NULL, 16));
+	}
+    }
+    if (!ended) {
+	Fail("dump cut short");
+    }
+
+    // decode once to count, then again to print with times
+    std::vector<BlackBoxSample> rows;
+    for (size_t at = 0; at < bytes.size(); ) {
+	uint8_t count;
+	at += BlackBox::Decode(bytes.data(), bytes.size(), at, s, count);
+	for (uint8_t i = 0; i < count; i++) {
+	    rows.push_back(s);
+	}
+    }
+    if (rows.size() != samples) {
+	fprintf(stderr, "bbdecode: %zu samples decoded, dump says %lu\n",
+		rows.size(), samples);
+    }
+
+    printf("ms,state,joyx,joyy,vbat,venbl,left,right\n");
+    for (size_t i = 0; i < rows.size(); i++) {
+	const BlackBoxSample &r = rows[i];
+	long ms = -(long) (rows.size() - 1 - i) * period;
+	printf("%ld,%d,%d,%d,%d,%d,%d,%d\n", ms, r.v[BB_STATE],
+	       r.v[BB_JOYX], r.v[BB_JOYY], r.v[BB_VBAT], r.v[BB_VENBL],
+	       r.v[BB_LEFT], r.v[BB_RIGHT]);
+    }
+    return 0;
+}
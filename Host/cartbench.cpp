@@ -0,0 +1,268 @@
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Google Benchmark microbenchmarks of the control hot paths, run against
+** the stand-in Arduino layer and LCD model: the A2D reads, each state's
+** update, outputs and display, Display::Print() with changed and
+** unchanged rows, the fuel gauge and the formatters.  Host timings only
+** rank the pieces against each other and against another branch; they
+** are not AVR cycle counts.
+**
+** usage: cartbench [benchmark options]
+**	e.g. --benchmark_filter=State --benchmark_format=json
+**
+** 'cmake --build . --target bench' writes bench.json in the build
+** directory; compare two of them with Google Benchmark's compare.py.
+*/
+#include <benchmark/benchmark.h>
+#include <Arduino.h>
+#include "Sim.h"
+#include "../CartBotControl/Hardware.h"
+#include "../CartBotControl/CartBot.h"
+#include "../CartBotControl/Display.h"
+#include "../CartBotControl/Format.h"
+
+#define	VBAT		870	// about 12.6V
+#define	CENTER		512
+
+static const char *const stateName[NUM_STATES] = {
+    "POWER ON", "INIT", "DISABLED", "ENABLED", "CONTROL FAULT",
+    "BATTERY FAULT", "TEST"
+};
+
+// the parts of CartBot the benchmarks reach into
+class CartBench {
+public:
+    // put the bot in 'state' with inputs that keep it there
+    static void Enter( StateId state )
+    {
+	bool driving = state == STATE_ENABLED;
+	bool stuck = state == STATE_CONTROL_FAULT;
+	Sim::SetAnalog(JOYX_PIN, CENTER);
+	Sim::SetAnalog(JOYY_PIN, driving || stuck ? 800 : CENTER);
+	Sim::SetAnalog(VBAT_PIN, VBAT);
+	Sim::SetAnalog(VENBL_PIN, driving ? VBAT : 0);
+	Sim::Advance(20000);	// a fresh ADC window
+
+	CartBot &bot = CartBot::GetInstance();
+	bot.inputs = InputEvents();
+	bot.SeedInputs();
+	bot.events = 0;
+	bot.machine.Start(bot, state);
+    }
+
+    // false if a transition was chosen meanwhile
+    static bool Stayed( StateId state )
+    {
+	CartBot &bot = CartBot::GetInstance();
+	bot.machine.Apply(bot);
+	return bot.machine.Current() == state;
+    }
+
+    static void UpdateState()
+    {
+	CartBot &bot = CartBot::GetInstance();
+	bot.machine.UpdateState(bot, EVENT_TICK);
+    }
+
+    static void UpdateOutputs()
+    {
+	CartBot &bot = CartBot::GetInstance();
+	bot.machine.UpdateOutputs(bot);
+    }
+
+    static void UpdateDisplay() { CartBot::GetInstance().UpdateDisplay(); }
+    static void ReadJoystick() { CartBot::GetInstance().ReadJoystick(); }
+    static void ReadBattery() { CartBot::GetInstance().ReadBattery(); }
+    static void ReadEnable() { CartBot::GetInstance().ReadEnable(); }
+
+    static void SetVBat( int vbat ) { CartBot::GetInstance().vbat = vbat; }
+};
+
+////////////////////////////////////////
+//
+// A2D reads
+//
+////////////////////////////////////////
+
+static void BM_ReadJoystick( benchmark::State &state )
+{
+    CartBench::Enter(STATE_DISABLED);
+    for (auto _ : state) {
+	CartBench::ReadJoystick();
+    }
+}
+BENCHMARK(BM_ReadJoystick);
+
+static void BM_ReadBattery( benchmark::State &state )
+{
+    CartBench::Enter(STATE_DISABLED);
+    for (auto _ : state) {
+	CartBench::ReadBattery();
+    }
+}
+BENCHMARK(BM_ReadBattery);
+
+static void BM_ReadEnable( benchmark::State &state )
+{
+    CartBench::Enter(STATE_DISABLED);
+    for (auto _ : state) {
+	CartBench::ReadEnable();
+    }
+}
+BENCHMARK(BM_ReadEnable);
+
+////////////////////////////////////////
+//
+// each state's actions
+//
+////////////////////////////////////////
+
+static void EachState( benchmark::internal::Benchmark *b )
+{
+    for (int s = 0; s < NUM_STATES; s++) {
+	b->Arg(s);
+    }
+}
+
+template <void (*F)()>
+static void BM_State( benchmark::State &state )
+{
+    StateId s = (StateId) state.range(0);
+    state.SetLabel(stateName[s]);
+    CartBench::Enter(s);
+    for (auto _ : state) {
+	F();
+    }
+    if (!CartBench::Stayed(s)) {
+	state.SkipWithError("left the state");
+    }
+}
+BENCHMARK_TEMPLATE(BM_State, CartBench::UpdateState)
+    ->Name("BM_UpdateState")->Apply(EachState);
+BENCHMARK_TEMPLATE(BM_State, CartBench::UpdateOutputs)
+    ->Name("BM_UpdateOutputs")->Apply(EachState);
+BENCHMARK_TEMPLATE(BM_State, CartBench::UpdateDisplay)
+    ->Name("BM_UpdateDisplay")->Apply(EachState);
+
+////////////////////////////////////////
+//
+// display
+//
+////////////////////////////////////////
+
+// the same three rows every time: composing finds nothing to send
+static void BM_PrintUnchanged( benchmark::State &state )
+{
+    Display &display = CartBot::GetDisplay();
+    for (auto _ : state) {
+	display.Print(
+	    FLASH_ROW("       READY        "),
+	    FLASH_ROW("push button to drive"),
+	    FLASH_ROW("                    ")
+	);
+	display.Commit();
+    }
+}
+BENCHMARK(BM_PrintUnchanged);
+
+// alternate between two screens: every row differs from the last frame
+static void BM_PrintChanged( benchmark::State &state )
+{
+    Display &display = CartBot::GetDisplay();
+    bool flip = false;
+    for (auto _ : state) {
+	if (flip) {
+	    display.Print(
+		FLASH_ROW("       READY        "),
+		FLASH_ROW("push button to drive"),
+		FLASH_ROW("                    ")
+	    );
+	} else {
+	    display.Print(
+		FLASH_ROW(" CHECKING CONTROLS  "),
+		FLASH_ROW("     please wait    "),
+		FLASH_ROW("   hands off, too   ")
+	    );
+	}
+	flip = !flip;
+	display.Commit();
+    }
+}
+BENCHMARK(BM_PrintChanged);
+
+// across the battery range, so the gauge and its glyph change
+static void BM_ShowFuelGauge( benchmark::State &state )
+{
+    CartBench::Enter(STATE_DISABLED);
+    int vbat = VBAT_MIN;
+    for (auto _ : state) {
+	CartBench::SetVBat(vbat);
+	CartBot::GetInstance().ShowFuelGauge();
+	if (++vbat > VBAT_MAX) {
+	    vbat = VBAT_MIN;
+	}
+    }
+}
+BENCHMARK(BM_ShowFuelGauge);
+
+////////////////////////////////////////
+//
+// formatters, over the A2D range
+//
+////////////////////////////////////////
+
+static void BM_Itoa4( benchmark::State &state )
+{
+    char buf[4];
+    int n = 0;
+    for (auto _ : state) {
+	itoa4(buf, n);
+	benchmark::DoNotOptimize(buf);
+	n = (n + 1) & 1023;
+    }
+}
+BENCHMARK(BM_Itoa4);
+
+static void BM_Fixtoa2x1( benchmark::State &state )
+{
+    char buf[4];
+    int n = 0;
+    for (auto _ : state) {
+	fixtoa2x1(buf, VBAT_DECIVOLTS.Apply(n));
+	benchmark::DoNotOptimize(buf);
+	n = (n + 1) & 1023;
+    }
+}
+BENCHMARK(BM_Fixtoa2x1);
+
+static void BM_Fixtoa1x2( benchmark::State &state )
+{
+    char buf[4];
+    int n = 0;
+    for (auto _ : state) {
+	fixtoa1x2(buf, ADC_CENTIVOLTS.Apply(n));
+	benchmark::DoNotOptimize(buf);
+	n = (n + 1) & 1023;
+    }
+}
+BENCHMARK(BM_Fixtoa1x2);
+
+int main( int argc, char **argv )
+{
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+	return 1;
+    }
+
+    Sim::Reset();
+    Sim::AttachLcd(I2C_ADDR, EN_PIN, RW_PIN, RS_PIN,
+		   D4_PIN, D5_PIN, D6_PIN, D7_PIN, BACKLIGHT_PIN);
+    Sim::SetDigital(TEST_PIN, HIGH);
+    setup();
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
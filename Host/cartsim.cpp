@@ -0,0 +1,227 @@
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Faster-than-real-time simulator.  Runs the unmodified sketch against
+** the stand-in Arduino layer and a simulated cart/driver.  Idle time is
+** skipped - by the sketch's own sleep when it ticks from the timer
+** interrupt, or by jumping the clock to the next deadline when it polls -
+** so CartBot::Run() is stepped as fast as the host allows.
+**
+** usage: cartsim [-t seconds] [-s seed] [-v] [-g] [-b] [-T file] [-R file]
+**	-t	simulated time to run (default one hour)
+**	-s	random seed for the driver and noise
+**	-v	print every change of the top display row as it happens
+**	-g	just print the sketch's state diagram, for Graphviz
+**	-b	dump the black box at the end too, for Host/bbdecode
+**	-T	turn on telemetry and write the serial stream to a file or
+**		pty, for Host/telemrx
+**	-R	record the inputs presented to the sketch as a trace, for
+**		Host/replay
+**
+** At the end the sketch is asked for its loop timing statistics over
+** the simulated serial port, as a user would ask a real cart.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <Arduino.h>
+#include "Sim.h"
+#include "Hd44780.h"
+#include "Scenario.h"
+#include "Trace.h"
+#include "../CartBotControl/Hardware.h"
+#include "../CartBotControl/CartBot.h"
+#include "../CartBotControl/Display.h"
+#include "../CartBotControl/Ticker.h"
+#include "../CartBotControl/JoystickFilter.h"
+
+static double WallSeconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void Usage()
+{
+    fprintf(stderr,
+	    "usage: cartsim [-t seconds] [-s seed] [-v] [-g] [-b] [-T file]"
+	    " [-R file]\n");
+    exit(2);
+}
+
+int main( int argc, char **argv )
+{
+    double seconds = 3600;
+    unsigned long seed = 1;
+    bool verbose = false;
+    bool graph = false;
+    bool blackbox = false;
+    const char *telemetry = NULL;
+    const char *record = NULL;
+
+    for (int i = 1; i < argc; i++) {
+	if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+	    seconds = atof(argv[++i]);
+	} else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+	    seed = strtoul(argv[++i], NULL, 0);
+	} else if (!strcmp(argv[i], "-v")) {
+	    verbose = true;
+	} else if (!strcmp(argv[i], "-g")) {
+	    graph = true;
+	} else if (!strcmp(argv[i], "-b")) {
+	    blackbox = true;
+	} else if (!strcmp(argv[i], "-T") && i + 1 < argc) {
+	    telemetry = argv[++i];
+	} else if (!strcmp(argv[i], "-R") && i + 1 < argc) {
+	    record = argv[++i];
+	} else {
+	    Usage();
+	}
+    }
+
+    Sim::Reset();
+    if (graph) {
+	// asked for over the serial port, as from a real cart
+	Sim::SetSerialOutput(stdout);
+	setup();
+	Sim::SerialInput("g");
+	while (Serial.available()) {
+	    loop();
+	}
+	return 0;
+    }
+
+    Hd44780 &lcd = Sim::AttachLcd(I2C_ADDR, EN_PIN, RW_PIN, RS_PIN,
+				  D4_PIN, D5_PIN, D6_PIN, D7_PIN,
+				  BACKLIGHT_PIN);
+    Scenario scenario(ScenarioParams(), seed);
+    FILE *trace = NULL;
+    if (record) {
+	trace = fopen(record, "w");
+	if (!trace) {
+	    perror(record);
+	    return 1;
+	}
+	WriteInputsHeader(trace);
+    }
+    scenario.Step(0);
+    if (trace) {
+	WriteRow(trace, TraceInputs::Capture(0));
+    }
+
+    uint64_t end = (uint64_t) (seconds * 1e6);
+    uint64_t nextStep = 0;
+    unsigned long ticks = 0;
+    unsigned long driving = 0;
+    int pulseMin = 0, pulseMax = 0;
+    char top[Hd44780::COLS + 1] = "";
+
+    FILE *stream = NULL;
+    if (telemetry) {
+	stream = fopen(telemetry, "wb");
+	if (!stream) {
+	    perror(telemetry);
+	    return 1;
+	}
+	Sim::SetSerialOutput(stream);
+    }
+
+    double start = WallSeconds();
+    setup();
+    if (stream) {
+	Sim::SerialInput("t");
+    }
+    while (Sim::Now() < end) {
+	uint64_t before = Sim::Now();
+	unsigned long taken = Ticker::Count();
+	if (before >= nextStep) {
+	    scenario.Step(before);
+	    if (trace) {
+		WriteRow(trace, TraceInputs::Capture(before));
+	    }
+	    nextStep = before + LOOP_TIME * 1000;
+	}
+	loop();
+	if (Sim::Now() == before) {
+	    // polling and nothing due: skip to the deadline
+	    Sim::AdvanceTo((uint64_t) Ticker::Deadline() * 1000);
+	}
+	if (Ticker::Count() == taken) {
+	    continue;
+	}
+	ticks++;
+
+	int left = Sim::GetServoPulse(LEFTMOTOR_PIN);
+	int right = Sim::GetServoPulse(RIGHTMOTOR_PIN);
+	if (left || right) {
+	    driving++;
+	    int lo = left < right ? left : right;
+	    int hi = left > right ? left : right;
+	    if (!pulseMin || lo < pulseMin) pulseMin = lo;
+	    if (hi > pulseMax) pulseMax = hi;
+	}
+
+	if (verbose) {
+	    char row[Hd44780::COLS + 1];
+	    lcd.Row(0, row);
+	    if (strcmp(row, top) != 0) {
+		strcpy(top, row);
+		printf("%10.3f  |%s|  %5.2fV\n", Sim::Now() * 1e-6, row,
+		       scenario.Battery());
+	    }
+	}
+    }
+    double wall = WallSeconds() - start;
+    if (trace) {
+	fclose(trace);
+    }
+
+    if (stream) {
+	Sim::SerialInput("t");
+	while (Serial.available()) {
+	    loop();
+	}
+	fclose(stream);
+    }
+
+    const Sim::I2cStats &i2c = Sim::GetI2cStats();
+    double simulated = Sim::Now() * 1e-6;
+    printf("simulated %.1f s in %.3f s: %lu ticks, %.2fM ticks/s, %.0fx real time\n",
+	   simulated, wall, ticks, ticks / wall * 1e-6, simulated / wall);
+    printf("motors driven %.1f%% of ticks, pulse %d..%d us\n",
+	   100.0 * driving / ticks, pulseMin, pulseMax);
+    printf("i2c: %lu transmissions, %lu bytes, %.1f%% of time on the bus\n",
+	   i2c.transmissions, i2c.bytes, 100.0 * i2c.busMicros / Sim::Now());
+    printf("lcd: %lu instructions, %lu data writes, %lu busy violations\n",
+	   lcd.instructions, lcd.dataWrites, lcd.busyViolations);
+    printf("joystick filter latency %ld us, %d ticks\n",
+	   JoystickFilter::LATENCY_US, JoystickFilter::LATENCY_TICKS);
+    const JoystickCal &cal = CartBot::GetInstance().GetJoystickCal();
+    for (int i = 0; i < 2; i++) {
+	const AxisCal &a = cal.Cal(i);
+	printf("joystick %c: %d..%d..%d, noise %d%s\n", "xy"[i],
+	       a.min, a.center, a.max, a.noise,
+	       cal.IsCalibrated() ? "" : " (uncalibrated)");
+    }
+    printf("eeprom: %lu bytes written\n", Sim::GetEepromWrites());
+    printf("battery %.2fV\n", scenario.Battery());
+    for (int r = 0; r < Hd44780::ROWS; r++) {
+	char row[Hd44780::COLS + 1];
+	lcd.Row(r, row);
+	for (char *c = row; *c; c++) {
+	    if ((unsigned char) *c < ' ') *c = '#';	// custom glyphs
+	}
+	printf("  |%s|\n", row);
+    }
+
+    fflush(stdout);
+    Sim::SetSerialOutput(stdout);
+    Sim::SerialInput(blackbox ? "sb" : "s");
+    while (Serial.available()) {
+	loop();
+    }
+    return 0;
+}
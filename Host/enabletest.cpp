@@ -0,0 +1,142 @@
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Measures how long the sketch takes to start the motors when the
+** enable button is pressed, and to stop them when it is let go, over
+** presses and releases at every phase of the tick.  Letting go has to
+** stop the motors within two ticks of the ADC window seeing it.
+**
+** usage: enabletest		exit status 0 if every stop was in time
+*/
+#include <stdio.h>
+#include <Arduino.h>
+#include "Sim.h"
+#include "../CartBotControl/Hardware.h"
+#include "../CartBotControl/AdcSampler.h"
+#include "../CartBotControl/CartBot.h"
+#include "../CartBotControl/Display.h"
+#include "../CartBotControl/Ticker.h"
+
+#define	TRIALS		50
+#define	VBAT		870	// about 12.6V
+#define	CENTER		512
+
+// release to stop: the ADC window has to fall below ENABLE_PCT of Vbat,
+// a few percent of the window, then ENABLE_DEBOUNCE ticks
+#define	ADC_WINDOW_US	(ADC_OVERSAMPLE * ADC_ROUND_US)
+#define	STOP_LIMIT_US	(ENABLE_DEBOUNCE * LOOP_TIME * 1000L + \
+			 ADC_WINDOW_US * (100 - ENABLE_PCT) / 100 + \
+			 ADC_ROUND_US)
+
+static void Step()
+{
+    uint64_t before = Sim::Now();
+    loop();
+    if (Sim::Now() == before) {
+	Sim::AdvanceTo((uint64_t) Ticker::Deadline() * 1000);
+    }
+}
+
+static void RunFor( uint64_t us )
+{
+    uint64_t end = Sim::Now() + us;
+    while (Sim::Now() < end) {
+	Step();
+    }
+}
+
+// microseconds until the left motor is driven (or not), or 0 on
+// timeout; timed from the servo itself, not from when loop() returned
+static uint64_t TimeUntilDriven( bool driven )
+{
+    uint64_t start = Sim::Now();
+    while (Sim::Now() - start < 1000000) {
+	if ((Sim::GetServoPulse(LEFTMOTOR_PIN) != 0) == driven) {
+	    return Sim::GetServoChanged(LEFTMOTOR_PIN) - start;
+	}
+	Step();
+    }
+    return 0;
+}
+
+struct Latency {
+    uint64_t min, max, total;
+    int count;
+
+    Latency() : min(~0ULL), max(0), total(0), count(0) {}
+
+    void Add( uint64_t us )
+    {
+	if (us < min) min = us;
+	if (us > max) max = us;
+	total += us;
+	count++;
+    }
+
+    void Print( const char *what ) const
+    {
+	printf("%-8s min %5.2f  mean %5.2f  max %5.2f ms\n", what,
+	       min * 1e-3, total * 1e-3 / count, max * 1e-3);
+    }
+};
+
+int main()
+{
+    Sim::Reset();
+    Sim::AttachLcd(I2C_ADDR, EN_PIN, RW_PIN, RS_PIN,
+		   D4_PIN, D5_PIN, D6_PIN, D7_PIN, BACKLIGHT_PIN);
+    Sim::SetAnalog(JOYX_PIN, CENTER);
+    Sim::SetAnalog(JOYY_PIN, CENTER);
+    Sim::SetAnalog(VBAT_PIN, VBAT);
+    Sim::SetAnalog(VENBL_PIN, 0);
+    Sim::SetDigital(TEST_PIN, HIGH);
+
+    setup();
+    while (CartBot::GetInstance().GetState() != STATE_DISABLED) {
+	if (Sim::Now() > 10000000) {
+	    printf("never got to DISABLED\n");
+	    return 1;
+	}
+	Step();
+    }
+
+    Latency press, release;
+    int failures = 0;
+    for (int i = 0; i < TRIALS; i++) {
+	// walk through the tick: each trial starts a little later
+	RunFor(200000 + i * (LOOP_TIME * 1000 / TRIALS + 37));
+
+	Sim::SetAnalog(VENBL_PIN, VBAT);
+	uint64_t go = TimeUntilDriven(true);
+	if (!go) {
+	    printf("trial %d: motors never started\n", i);
+	    return 1;
+	}
+	press.Add(go);
+
+	// drive a little, back to center, then let go at some other phase
+	Sim::SetAnalog(JOYY_PIN, 800);
+	RunFor(300000);
+	Sim::SetAnalog(JOYY_PIN, CENTER);
+	RunFor(100000 + (i * 7 % TRIALS) * (LOOP_TIME * 1000 / TRIALS));
+
+	Sim::SetAnalog(VENBL_PIN, 0);
+	uint64_t stop = TimeUntilDriven(false);
+	if (!stop) {
+	    printf("trial %d: motors never stopped\n", i);
+	    return 1;
+	}
+	release.Add(stop);
+	if (stop > STOP_LIMIT_US) {
+	    printf("trial %d: stopped after %.2f ms\n", i, stop * 1e-3);
+	    failures++;
+	}
+    }
+
+    press.Print("press");
+    release.Print("release");
+    printf("limit %.2f ms: %d of %d releases late\n", STOP_LIMIT_US * 1e-3,
+	   failures, TRIALS);
+    return failures ? 1 : 0;
+}
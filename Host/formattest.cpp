@@ -0,0 +1,107 @@
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Checks the fixed-point formatting in Format.h against the float code
+** TestState used before, for every ADC reading.  avr-gcc's double is a
+** 32-bit float, so the reference does its arithmetic in float throughout.
+**
+** usage: formattest		exit status 0 if everything matches
+*/
+#include <stdio.h>
+#include <string.h>
+#include "../CartBotControl/Format.h"
+
+static void ftoa2x1( char *buf, float f )
+{
+    int n = (f * 10.f + 0.5f);
+    int d = n % 10;
+    buf[3] = '0' + d;
+    buf[2] = '.';
+    n /= 10;
+    d = n % 10;
+    buf[1] = '0' + d;
+    n /= 10;
+    if (n) {
+	d = n % 10;
+	buf[0] = '0' + d;
+	n /= 10;
+	if (n) {
+	    buf[0] = buf[1] = buf[2] = buf[3] = '-';
+	}
+    } else {
+	buf[0] = ' ';
+    }
+}
+
+static void ftoa1x2( char *buf, float f )
+{
+    int n = (f * 100.f + 0.5f);
+    int d = n % 10;
+    buf[3] = '0' + d;
+    n /= 10;
+    d = n % 10;
+    buf[2] = '0' + d;
+    buf[1] = '.';
+    n /= 10;
+    d = n % 10;
+    buf[0] = '0' + d;
+    n /= 10;
+    if (n) {
+	buf[0] = buf[1] = buf[2] = buf[3] = '-';
+    }
+}
+
+static int failures;
+
+static void Check( const char *what, int n, const char *want, const char *got )
+{
+    if (memcmp(want, got, 4) != 0) {
+	if (++failures <= 20) {
+	    printf("%s %d: want \"%.4s\" got \"%.4s\"\n", what, n, want, got);
+	}
+    }
+}
+
+int main()
+{
+    // as avr-gcc folds it: in float
+    const float divider = 15.1e3f / 5.1e3f;
+
+    for (int adc = 0; adc < 1024; adc++) {
+	char want[4], got[4];
+
+	ftoa1x2(want, adc * 5.00f / 1024.f);
+	fixtoa1x2(got, ADC_CENTIVOLTS.Apply(adc));
+	Check("volts", adc, want, got);
+
+	ftoa2x1(want, adc * 5.00f / 1024.f * divider);
+	fixtoa2x1(got, VBAT_DECIVOLTS.Apply(adc));
+	Check("battery volts", adc, want, got);
+
+	ftoa2x1(want, adc * 100.0f / 1024.f);
+	fixtoa2x1(got, ADC_PERMILLE.Apply(adc));
+	Check("percent", adc, want, got);
+    }
+
+    // Pulse widths: 1/1000 isn't exact in float, so an odd 5us
+    // (1045, say) can come out a hair under the half and round down.
+    // Those now round up; everything else must match.
+    for (int us = 0; us < 3000; us++) {
+	char want[4], got[4];
+	fixtoa1x2(got, PULSE_CENTIMS.Apply(us));
+	if (us % 10 == 5) {
+	    ftoa1x2(want, (us + 5) / 1000.f);
+	} else {
+	    ftoa1x2(want, us / 1000.f);
+	}
+	Check("pulse", us, want, got);
+    }
+
+    if (failures) {
+	printf("%d mismatches\n", failures);
+	return 1;
+    }
+    printf("all values match\n");
+    return 0;
+}
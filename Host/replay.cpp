@@ -0,0 +1,196 @@
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Replays an input trace (see Trace.h) through the unmodified sketch
+** from power-on, on the virtual clock, and writes the state and motor
+** commands that come out: a row per tick where they changed.  Build two
+** firmware versions, replay the same trace through each, and compare
+** with -d to find every tick where their behavior differs.
+**
+** usage: replay [-o outputs.csv] inputs.csv
+**	  replay -d old.csv new.csv
+**	-o	write the outputs there instead of stdout
+**	-d	compare two outputs; exits 1 if they differ anywhere
+**
+** A trace is one power-on session, so a day of them goes wide with
+** e.g. 'ls *.csv | xargs -P8 -I{} replay -o {}.out {}'.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <Arduino.h>
+#include "Sim.h"
+#include "Trace.h"
+#include "../CartBotControl/Hardware.h"
+#include "../CartBotControl/CartBot.h"
+#include "../CartBotControl/Display.h"
+#include "../CartBotControl/Ticker.h"
+
+#define	MAX_REPORTED	20	// spans of difference printed by -d
+
+static void Usage()
+{
+    fprintf(stderr, "usage: replay [-o outputs.csv] inputs.csv\n"
+		    "       replay -d old.csv new.csv\n");
+    exit(2);
+}
+
+static int Replay( const char *inputs, FILE *out )
+{
+    TraceReader trace;
+    TraceInputs next;
+    if (!trace.OpenInputs(inputs)) {
+	return 2;
+    }
+    if (!trace.Next(next)) {
+	fprintf(stderr, "%s: no samples\n", inputs);
+	return 2;
+    }
+
+    Sim::Reset();
+    Sim::AttachLcd(I2C_ADDR, EN_PIN, RW_PIN, RS_PIN,
+		   D4_PIN, D5_PIN, D6_PIN, D7_PIN, BACKLIGHT_PIN);
+    next.Present();
+    uint64_t end = next.us;
+    bool more = trace.Next(next);
+
+    WriteOutputsHeader(out);
+    TraceOutputs last = { 0, -1, -1, -1 };
+
+    setup();
+    for (;;) {
+	uint64_t before = Sim::Now();
+	while (more && before >= next.us) {
+	    next.Present();
+	    end = next.us;
+	    more = trace.Next(next);
+	}
+	if (!more && before >= end + LOOP_TIME * 1000) {
+	    break;
+	}
+
+	unsigned long taken = Ticker::Count();
+	loop();
+	if (Sim::Now() == before) {
+	    Sim::AdvanceTo((uint64_t) Ticker::Deadline() * 1000);
+	}
+	if (Ticker::Count() == taken) {
+	    continue;
+	}
+
+	TraceOutputs o;
+	o.ms = before / 1000 / LOOP_TIME * LOOP_TIME;
+	o.state = CartBot::GetInstance().GetState();
+	o.left = Sim::GetServoPulse(LEFTMOTOR_PIN);
+	o.right = Sim::GetServoPulse(RIGHTMOTOR_PIN);
+	if (o != last) {
+	    WriteRow(out, o);
+	    last = o;
+	}
+    }
+    return 0;
+}
+
+// The outputs hold between rows, so walk both in time order and report
+// the spans where they disagree.
+static int Diff( const char *oldPath, const char *newPath )
+{
+    TraceReader trace[2];
+    if (!trace[0].OpenOutputs(oldPath) || !trace[1].OpenOutputs(newPath)) {
+	return 2;
+    }
+
+    TraceOutputs cur[2], next[2];
+    bool more[2];
+    for (int i = 0; i < 2; i++) {
+	cur[i].ms = 0;
+	cur[i].state = cur[i].left = cur[i].right = -1;
+	more[i] = trace[i].Next(next[i]);
+    }
+
+    unsigned long spans = 0, ticks = 0;
+    bool differing = false;
+    TraceOutputs from[2] = {};
+    uint32_t start = 0, now = 0;
+
+    while (more[0] || more[1]) {
+	now = !more[1] || (more[0] && next[0].ms < next[1].ms)
+	      ? next[0].ms : next[1].ms;
+	for (int i = 0; i < 2; i++) {
+	    if (more[i] && next[i].ms == now) {
+		cur[i] = next[i];
+		more[i] = trace[i].Next(next[i]);
+	    }
+	}
+
+	if (cur[0] != cur[1] && !differing) {
+	    differing = true;
+	    start = now;
+	    from[0] = cur[0];
+	    from[1] = cur[1];
+	} else if (cur[0] == cur[1] && differing) {
+	    differing = false;
+	    ticks += (now - start) / LOOP_TIME;
+	    if (++spans <= MAX_REPORTED) {
+		printf("%lu..%lu ms: state %d/%d, left %d/%d, right %d/%d\n",
+		       (unsigned long) start, (unsigned long) now,
+		       from[0].state, from[1].state, from[0].left,
+		       from[1].left, from[0].right, from[1].right);
+	    }
+	}
+    }
+    if (differing) {
+	// to the end of the longer one
+	now += LOOP_TIME;
+	ticks += (now - start) / LOOP_TIME;
+	if (++spans <= MAX_REPORTED) {
+	    printf("%lu.. ms: state %d/%d, left %d/%d, right %d/%d\n",
+		   (unsigned long) start, from[0].state, from[1].state,
+		   from[0].left, from[1].left, from[0].right, from[1].right);
+	}
+    }
+
+    if (spans) {
+	printf("%lu ticks differ, in %lu spans\n", ticks, spans);
+	return 1;
+    }
+    printf("same, through %lu ms\n", (unsigned long) now);
+    return 0;
+}
+
+int main( int argc, char **argv )
+{
+    const char *output = NULL;
+    const char *diff = NULL;
+    const char *input = NULL;
+
+    for (int i = 1; i < argc; i++) {
+	if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+	    output = argv[++i];
+	} else if (!strcmp(argv[i], "-d") && i + 1 < argc) {
+	    diff = argv[++i];
+	} else if (!input && (argv[i][0] != '-' || !argv[i][1])) {
+	    input = argv[i];
+	} else {
+	    Usage();
+	}
+    }
+    if (!input) {
+	Usage();
+    }
+    if (diff) {
+	return Diff(diff, input);
+    }
+
+    FILE *out = stdout;
+    if (output && !(out = fopen(output, "w"))) {
+	perror(output);
+	return 2;
+    }
+    int status = Replay(input, out);
+    if (out != stdout) {
+	fclose(out);
+    }
+    return status;
+}
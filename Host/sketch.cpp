@@ -0,0 +1,9 @@
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** The Arduino IDE prepends <Arduino.h> to the sketch and compiles it as
+** C++; do the same here so CartBotControl.ino builds unchanged.
+*/
+#include <Arduino.h>
+#include "../CartBotControl/CartBotControl.ino"
@@ -0,0 +1,499 @@
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Monte-Carlo sweep of the state machine against noisy inputs.  Every
+** scenario gets its own randomized cart and driver - ADC noise, battery
+** level, drain and sag, pot drift and wander, enable bounce - and runs
+** from power-on in a fresh copy of the sketch.  The sketch and the
+** simulator are process globals, so the copies are processes: one
+** worker per core takes the next scenario number from a shared counter
+** whenever it finishes one, and forks each scenario off a pristine
+** image of itself.  Totals come back through shared memory.
+**
+** usage: sweep [-n scenarios] [-m minutes] [-j jobs] [-s seed]
+**	  sweep -i index [-m minutes] [-s seed] [-R file]
+**	-n	scenarios to run (default 1000)
+**	-m	simulated minutes each (default 1)
+**	-j	worker processes (default one per core)
+**	-s	seed the scenarios are derived from
+**	-i	run just the one scenario and print its parameters, as
+**		named in a sweep report
+**	-R	record that scenario's inputs, for Host/replay
+**
+** Reports entries into each state, CONTROL FAULTs with the controls
+** left alone (spurious) and in use (caught: the stick grabbed, or
+** enable pressed before the cart was ready), and the times from power-on
+** to DISABLED, from pressing enable to the motors running - timed from
+** the driver's first touch, so bounce adds to it - and from the contact
+** settling open to the motors stopping, which is held to STOP_LIMIT_US.
+** Exit status 1 if anything was spurious, a stop was late or a scenario
+** crashed.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <atomic>
+#include <new>
+#include <Arduino.h>
+#include "Sim.h"
+#include "Scenario.h"
+#include "Trace.h"
+#include "../CartBotControl/Hardware.h"
+#include "../CartBotControl/AdcSampler.h"
+#include "../CartBotControl/CartBot.h"
+#include "../CartBotControl/Display.h"
+#include "../CartBotControl/Ticker.h"
+
+#define	MAX_JOBS	256
+#define	LATENCY_BUCKETS	1000	// of a millisecond, the last open-ended
+#define	PRESS_TIMEOUT	3000000	// the driver gives up holding enable
+
+// as in enabletest: the ADC window, the threshold and the debounce
+#define	STOP_LIMIT_US	(ENABLE_DEBOUNCE * LOOP_TIME * 1000L + \
+			 ADC_OVERSAMPLE * ADC_ROUND_US * \
+			 (100 - ENABLE_PCT) / 100 + ADC_ROUND_US)
+
+static const char *const stateName[NUM_STATES] = {
+    "POWER ON", "INIT", "DISABLED", "ENABLED", "CONTROL FAULT",
+    "BATTERY FAULT", "TEST",
+};
+
+struct Latency {
+    uint64_t count, total, min, max;
+    uint32_t bucket[LATENCY_BUCKETS];
+
+    void Add( uint64_t us )
+    {
+	if (count == 0 || us < min) min = us;
+	if (us > max) max = us;
+	total += us;
+	count++;
+	uint64_t b = us / 1000;
+	bucket[b < LATENCY_BUCKETS ? b : LATENCY_BUCKETS - 1]++;
+    }
+
+    void Merge( const Latency &o )
+    {
+	if (o.count == 0) return;
+	if (count == 0 || o.min < min) min = o.min;
+	if (o.max > max) max = o.max;
+	total += o.total;
+	count += o.count;
+	for (int i = 0; i < LATENCY_BUCKETS; i++) {
+	    bucket[i] += o.bucket[i];
+	}
+    }
+
+    // upper edge of the bucket holding the given fraction, in ms;
+    // LATENCY_BUCKETS if it's in the open-ended one
+    int Percentile( double fraction ) const
+    {
+	uint64_t want = (uint64_t) (count * fraction), seen = 0;
+	for (int i = 0; i < LATENCY_BUCKETS; i++) {
+	    seen += bucket[i];
+	    if (seen > want) return i + 1;
+	}
+	return LATENCY_BUCKETS;
+    }
+
+    void Print( const char *what ) const
+    {
+	if (count == 0) {
+	    printf("%-10s none\n", what);
+	    return;
+	}
+	int p99 = Percentile(0.99);
+	printf("%-10s %9llu  min %8.2f  mean %8.2f  99%% %c%5d  max %8.2f ms\n",
+	       what, (unsigned long long) count, min * 1e-3,
+	       total * 1e-3 / count, p99 < LATENCY_BUCKETS ? '<' : '>',
+	       p99 < LATENCY_BUCKETS ? p99 : p99 - 1, max * 1e-3);
+    }
+};
+
+// a scenario's results, and the sum of many
+struct Totals {
+    uint64_t scenarios;
+    uint64_t simulated;		// microseconds
+    uint64_t crashed;		// scenario processes that died
+    uint64_t entries[NUM_STATES];
+    uint64_t spurious;		// CONTROL FAULTs with the controls let be
+    uint64_t caught;		// ... and with one in use
+    uint64_t neverReady;	// scenarios that never got to DISABLED
+    uint64_t ignored;		// presses given up on, motors never ran
+    uint64_t lateStops;		// releases slower than STOP_LIMIT_US
+    Latency boot, press, release;
+    int64_t firstSpurious;	// scenario numbers to look at, or -1
+    int64_t slowestStop;
+
+    void Clear()
+    {
+	memset(this, 0, sizeof *this);
+	firstSpurious = slowestStop = -1;
+    }
+
+    void Merge( const Totals &o )
+    {
+	scenarios += o.scenarios;
+	simulated += o.simulated;
+	crashed += o.crashed;
+	for (int i = 0; i < NUM_STATES; i++) {
+	    entries[i] += o.entries[i];
+	}
+	spurious += o.spurious;
+	caught += o.caught;
+	neverReady += o.neverReady;
+	ignored += o.ignored;
+	lateStops += o.lateStops;
+	if (o.firstSpurious >= 0 &&
+	    (firstSpurious < 0 || o.firstSpurious < firstSpurious)) {
+	    firstSpurious = o.firstSpurious;
+	}
+	if (o.slowestStop >= 0 && o.release.max > release.max) {
+	    slowestStop = o.slowestStop;
+	}
+	boot.Merge(o.boot);
+	press.Merge(o.press);
+	release.Merge(o.release);
+    }
+};
+
+// what the workers share: the next scenario to take, and a slot each
+// for the scenario in hand and for their running totals
+struct Shared {
+    std::atomic<uint64_t> next;
+    Totals scenario[MAX_JOBS];
+    Totals worker[MAX_JOBS];
+};
+
+static uint64_t SplitMix( uint64_t &x )
+{
+    uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static double Uniform( uint64_t &x, double lo, double hi )
+{
+    return lo + (hi - lo) * ((SplitMix(x) >> 11) * (1.0 / 9007199254740992.0));
+}
+
+// scenario 'index' of the sweep seeded with 'seed', always the same
+static ScenarioParams RandomParams( uint64_t seed, uint64_t index,
+				    uint64_t &scenarioSeed )
+{
+    uint64_t x = seed * 0x100000001B3ULL ^ index;
+    ScenarioParams p;
+    p.batteryStart = Uniform(x, 11.0, 13.4);
+    p.drainIdle = Uniform(x, 0.05, 0.5);
+    p.drainDrive = Uniform(x, 0.5, 4);
+    p.sag = Uniform(x, 0, 1.5);
+    p.adcNoise = (int) Uniform(x, 0, 9);
+    p.joyOffsetX = (int) Uniform(x, -60, 61);
+    p.joyOffsetY = (int) Uniform(x, -60, 61);
+    p.joyWander = (int) Uniform(x, 0, 21);
+    p.bounce = Uniform(x, 0, 0.02);
+    p.idleMin = Uniform(x, 0.5, 3);
+    p.idleMax = p.idleMin + Uniform(x, 1, 15);
+    p.driveMin = Uniform(x, 1, 5);
+    p.driveMax = p.driveMin + Uniform(x, 1, 30);
+    p.fumbleChance = Uniform(x, 0, 0.2);
+    scenarioSeed = SplitMix(x);
+    return p;
+}
+
+static void PrintParams( const ScenarioParams &p )
+{
+    printf("battery %.2fV, drain %.2f+%.2f V/h, sag %.2fV\n",
+	   p.batteryStart, p.drainIdle, p.drainDrive, p.sag);
+    printf("adc noise +/-%d, joystick offset %d,%d, wander +/-%d\n",
+	   p.adcNoise, p.joyOffsetX, p.joyOffsetY, p.joyWander);
+    printf("enable bounce %.1f ms, idle %.1f..%.1f s, drive %.1f..%.1f s,"
+	   " fumble %.0f%%\n", p.bounce * 1e3, p.idleMin, p.idleMax,
+	   p.driveMin, p.driveMax, p.fumbleChance * 100);
+}
+
+// Runs one scenario from power-on in this process, which it leaves
+// used up: the sketch has no way back to its power-on state.
+static void RunScenario( const ScenarioParams &params, uint64_t seed,
+			 int64_t index, uint64_t us, Totals &t, FILE *trace )
+{
+    Sim::Reset();
+    Sim::AttachLcd(I2C_ADDR, EN_PIN, RW_PIN, RS_PIN,
+		   D4_PIN, D5_PIN, D6_PIN, D7_PIN, BACKLIGHT_PIN);
+    Scenario scenario(params, seed);
+    scenario.Step(0);
+    if (trace) {
+	WriteRow(trace, TraceInputs::Capture(0));
+    }
+
+    CartBot &bot = CartBot::GetInstance();
+    uint64_t nextStep = 0;
+    StateId state = NUM_STATES;
+    bool ready = false;
+    bool pressed = false;
+    uint64_t pressAt = 0;
+    bool awaitStart = false, awaitStop = false;
+
+    setup();
+    while (Sim::Now() < us) {
+	uint64_t before = Sim::Now();
+	unsigned long taken = Ticker::Count();
+	if (before >= nextStep) {
+	    scenario.Step(before);
+	    if (trace) {
+		WriteRow(trace, TraceInputs::Capture(before));
+	    }
+	    nextStep = before + LOOP_TIME * 1000;
+
+	    if (scenario.EnablePressed() != pressed) {
+		pressed = !pressed;
+		if (pressed) {
+		    awaitStart = true;
+		    pressAt = scenario.EnableChanged();
+		} else {
+		    if (awaitStart) {
+			t.ignored++;
+			awaitStart = false;
+		    }
+		    awaitStop = Sim::GetServoPulse(LEFTMOTOR_PIN) != 0;
+		}
+	    }
+	}
+	loop();
+	if (Sim::Now() == before) {
+	    Sim::AdvanceTo((uint64_t) Ticker::Deadline() * 1000);
+	}
+	if (Ticker::Count() == taken) {
+	    continue;
+	}
+
+	StateId now = bot.GetState();
+	if (now != state) {
+	    state = now;
+	    t.entries[state]++;
+	    if (state == STATE_CONTROL_FAULT) {
+		if (scenario.HandsOff() && !scenario.EnablePressed()) {
+		    t.spurious++;
+		    if (t.firstSpurious < 0) t.firstSpurious = index;
+		} else {
+		    t.caught++;
+		}
+	    }
+	    if (state == STATE_DISABLED && !ready) {
+		ready = true;
+		t.boot.Add(Sim::Now());
+	    }
+	}
+
+	bool driven = Sim::GetServoPulse(LEFTMOTOR_PIN) != 0;
+	if (awaitStart && driven) {
+	    t.press.Add(Sim::GetServoChanged(LEFTMOTOR_PIN) - pressAt);
+	    awaitStart = false;
+	} else if (awaitStart && Sim::Now() - pressAt > PRESS_TIMEOUT) {
+	    t.ignored++;
+	    awaitStart = false;
+	}
+	if (awaitStop && !driven) {
+	    // from the end of the bounce, as the limit allows for none;
+	    // motors that stopped while it went on count as instant
+	    uint64_t off = Sim::GetServoChanged(LEFTMOTOR_PIN);
+	    uint64_t open = scenario.ContactChanged();
+	    uint64_t stop = off > open ? off - open : 0;
+	    t.release.Add(stop);
+	    if (stop > STOP_LIMIT_US) t.lateStops++;
+	    if (stop == t.release.max) t.slowestStop = index;
+	    awaitStop = false;
+	}
+    }
+
+    t.scenarios = 1;
+    t.simulated = Sim::Now();
+    if (!ready) t.neverReady++;
+}
+
+// one per core: take scenarios until there are none left
+static void Worker( Shared *shared, int slot, uint64_t count, uint64_t seed,
+		    uint64_t us )
+{
+    Totals &total = shared->worker[slot];
+    Totals &one = shared->scenario[slot];
+    total.Clear();
+
+    for (;;) {
+	uint64_t index = shared->next.fetch_add(1);
+	if (index >= count) {
+	    break;
+	}
+	one.Clear();
+	pid_t pid = fork();
+	if (pid == 0) {
+	    uint64_t scenarioSeed;
+	    ScenarioParams p = RandomParams(seed, index, scenarioSeed);
+	    RunScenario(p, scenarioSeed, index, us, one, NULL);
+	    _exit(0);
+	}
+	int status = 0;
+	if (pid < 0 || waitpid(pid, &status, 0) != pid ||
+	    !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+	    one.Clear();
+	    one.crashed = 1;
+	    if (one.firstSpurious < 0) one.firstSpurious = index;
+	}
+	total.Merge(one);
+    }
+}
+
+static double WallSeconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void Report( const Totals &t, double wall, int jobs )
+{
+    double minutes = t.simulated / 60e6;
+    printf("%llu scenarios, %.0f scenario-minutes in %.1f s on %d workers:"
+	   " %.0fx real time\n", (unsigned long long) t.scenarios, minutes,
+	   wall, jobs, t.simulated * 1e-6 / wall);
+    if (t.crashed) {
+	printf("%llu scenarios crashed\n", (unsigned long long) t.crashed);
+    }
+
+    printf("\nstate entries\n");
+    for (int i = 0; i < NUM_STATES; i++) {
+	printf("  %-14s %12llu\n", stateName[i],
+	       (unsigned long long) t.entries[i]);
+    }
+    printf("\ncontrol faults: %llu spurious, %llu with a control in use\n",
+	   (unsigned long long) t.spurious, (unsigned long long) t.caught);
+    if (t.firstSpurious >= 0) {
+	printf("  first spurious or crashed: scenario %lld\n",
+	       (long long) t.firstSpurious);
+    }
+    printf("never ready: %llu scenarios; presses ignored: %llu\n\n",
+	   (unsigned long long) t.neverReady, (unsigned long long) t.ignored);
+
+    t.boot.Print("ready");
+    t.press.Print("press");
+    t.release.Print("release");
+    printf("releases over %.2f ms: %llu", STOP_LIMIT_US * 1e-3,
+	   (unsigned long long) t.lateStops);
+    if (t.slowestStop >= 0) {
+	printf(", slowest in scenario %lld", (long long) t.slowestStop);
+    }
+    printf("\n");
+}
+
+static void Usage()
+{
+    fprintf(stderr,
+	    "usage: sweep [-n scenarios] [-m minutes] [-j jobs] [-s seed]\n"
+	    "       sweep -i index [-m minutes] [-s seed] [-R file]\n");
+    exit(2);
+}
+
+int main( int argc, char **argv )
+{
+    uint64_t count = 1000;
+    double minutes = 1;
+    long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    uint64_t seed = 1;
+    long long only = -1;
+    const char *record = NULL;
+
+    for (int i = 1; i < argc; i++) {
+	if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+	    count = strtoull(argv[++i], NULL, 0);
+	} else if (!strcmp(argv[i], "-m") && i + 1 < argc) {
+	    minutes = atof(argv[++i]);
+	} else if (!strcmp(argv[i], "-j") && i + 1 < argc) {
+	    jobs = atol(argv[++i]);
+	} else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+	    seed = strtoull(argv[++i], NULL, 0);
+	} else if (!strcmp(argv[i], "-i") && i + 1 < argc) {
+	    only = atoll(argv[++i]);
+	} else if (!strcmp(argv[i], "-R") && i + 1 < argc) {
+	    record = argv[++i];
+	} else {
+	    Usage();
+	}
+    }
+    if (jobs < 1) jobs = 1;
+    if (jobs > MAX_JOBS) jobs = MAX_JOBS;
+    uint64_t us = (uint64_t) (minutes * 60e6);
+
+    if (only >= 0) {
+	uint64_t scenarioSeed;
+	ScenarioParams p = RandomParams(seed, only, scenarioSeed);
+	PrintParams(p);
+	FILE *trace = NULL;
+	if (record) {
+	    trace = fopen(record, "w");
+	    if (!trace) {
+		perror(record);
+		return 1;
+	    }
+	    WriteInputsHeader(trace);
+	}
+	static Totals t;
+	t.Clear();
+	double start = WallSeconds();
+	RunScenario(p, scenarioSeed, only, us, t, trace);
+	if (trace) {
+	    fclose(trace);
+	}
+	printf("\n");
+	Report(t, WallSeconds() - start, 1);
+	return (t.spurious || t.lateStops) ? 1 : 0;
+    }
+
+    void *map = mmap(NULL, sizeof(Shared), PROT_READ | PROT_WRITE,
+		     MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) {
+	perror("mmap");
+	return 1;
+    }
+    Shared *shared = new (map) Shared;
+    shared->next = 0;
+
+    double start = WallSeconds();
+    fflush(stdout);
+    for (int w = 0; w < jobs; w++) {
+	pid_t pid = fork();
+	if (pid < 0) {
+	    perror("fork");
+	    return 1;
+	}
+	if (pid == 0) {
+	    Worker(shared, w, count, seed, us);
+	    _exit(0);
+	}
+    }
+    int failed = 0;
+    for (int w = 0; w < jobs; w++) {
+	int status;
+	if (wait(&status) < 0 || !WIFEXITED(status) ||
+	    WEXITSTATUS(status) != 0) {
+	    failed++;
+	}
+    }
+    if (failed) {
+	fprintf(stderr, "sweep: %d workers failed\n", failed);
+	return 1;
+    }
+
+    Totals total;
+    total.Clear();
+    for (int w = 0; w < jobs; w++) {
+	total.Merge(shared->worker[w]);
+    }
+    Report(total, WallSeconds() - start, (int) jobs);
+    return (total.spurious || total.lateStops || total.crashed) ? 1 : 0;
+}
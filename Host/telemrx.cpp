@@ -0,0 +1,187 @@
+/*
+** CartBot control software - host build
+** FRC Team 1425 "Error Code Xero"
+**
+** Receives the sketch's binary telemetry (see CartBotControl/Telemetry.h)
+** and writes it as CSV, a row per frame.  Reads a serial device or pty,
+** set raw at the given baud rate, or a capture on stdin such as
+** 'cartsim -T'.  Bad frames are skipped and lost ones counted; a
+** summary goes to stderr at the end of the input or on ^C.  The CSV
+** serves as an input trace for Host/replay.
+**
+** usage: telemrx [-b baud] [-s] [device] > telemetry.csv
+**	-b	baud rate for a tty (default SERIAL_BAUD)
+**	-s	send 't' first to start the stream
+**
+** To watch the simulator live, join two ptys with
+**	socat pty,raw,echo=0,link=/tmp/cart pty,raw,echo=0,link=/tmp/host
+** and run 'cartsim -T /tmp/cart' and 'telemrx /tmp/host'.
+*/
+#include "../CartBotControl/Telemetry.h"
+
+// the Arduino core's binary constants use some of termios's baud names
+#undef B0
+#undef B110
+#undef B1000000
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+static volatile sig_atomic_t stop = 0;
+
+static void OnSignal( int )
+{
+    stop = 1;
+}
+
+static speed_t Speed( long baud )
+{
+    switch (baud) {
+    case 9600:		return B9600;
+    case 19200:		return B19200;
+    case 38400:		return B38400;
+    case 57600:		return B57600;
+    case 115200:	return B115200;
+    case 230400:	return B230400;
+    case 460800:	return B460800;
+    case 500000:	return B500000;
+    case 1000000:	return B1000000;
+    }
+    fprintf(stderr, "telemrx: unsupported baud rate %ld\n", baud);
+    exit(2);
+}
+
+static void Usage()
+{
+    fprintf(stderr, "usage: telemrx [-b baud] [-s] [device]\n");
+    exit(2);
+}
+
+int main( int argc, char **argv )
+{
+    long baud = SERIAL_BAUD;
+    bool start = false;
+    const char *device = NULL;
+
+    for (int i = 1; i < argc; i++) {
+	if (!strcmp(argv[i], "-b") && i + 1 < argc) {
+	    baud = strtol(argv[++i], NULL, 0);
+	} else if (!strcmp(argv[i], "-s")) {
+	    start = true;
+	} else if (argv[i][0] != '-' && !device) {
+	    device = argv[i];
+	} else {
+	    Usage();
+	}
+    }
+
+    int fd = 0;
+    if (device) {
+	fd = open(device, (start ? O_RDWR : O_RDONLY) | O_NOCTTY);
+	if (fd < 0) {
+	    perror(device);
+	    return 1;
+	}
+    }
+    if (isatty(fd)) {
+	struct termios tio;
+	if (tcgetattr(fd, &tio) == 0) {
+	    cfmakeraw(&tio);
+	    cfsetspeed(&tio, Speed(baud));
+	    tio.c_cc[VMIN] = 1;
+	    tio.c_cc[VTIME] = 0;
+	    tcsetattr(fd, TCSANOW, &tio);
+	}
+	setvbuf(stdout, NULL, _IOLBF, 0);
+    }
+    if (start && write(fd, "t", 1) != 1) {
+	perror("telemrx: starting the stream");
+    }
+
+    // no SA_RESTART, so ^C ends a blocked read
+    struct sigaction sa;
+    memset(&sa, 0, sizeof sa);
+    sa.sa_handler = OnSignal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    printf("ms,seq,state,inputs,joyx,joyy,vbat,venbl,left,right,"
+	   "tick_us,overruns\n");
+
+    uint8_t frame[Telemetry::FRAME];
+    unsigned n = 0;
+    bool overflow = false;
+    bool first = true;
+    uint8_t seq = 0;
+    uint16_t ms = 0;
+    uint8_t overruns = 0;
+    unsigned long long now = 0;
+    unsigned long frames = 0, bad = 0, lost = 0;
+
+    while (!stop) {
+	uint8_t buf[256];
+	ssize_t got = read(fd, buf, sizeof buf);
+	if (got < 0 && errno == EINTR) {
+	    continue;
+	}
+	if (got <= 0) {
+	    break;
+	}
+	for (ssize_t i = 0; i < got; i++) {
+	    if (buf[i] != 0) {
+		if (n < sizeof frame) {
+		    frame[n++] = buf[i];
+		} else {
+		    overflow = true;
+		}
+		continue;
+	    }
+
+	    // a delimiter: whatever came before it is a frame, or noise
+	    uint8_t packed[Telemetry::FRAME];
+	    TelemetryFrame f;
+	    bool ok = n && !overflow &&
+		      Telemetry::Unpack(packed,
+					Telemetry::Unstuff(frame, n, packed),
+					f);
+	    if (n && !ok) {
+		bad++;
+	    }
+	    n = 0;
+	    overflow = false;
+	    if (!ok) {
+		continue;
+	    }
+
+	    // times and counts are the sketch's low bits; unwrap them.
+	    // Times start from millis(), so they count from power-on when
+	    // the stream was started within a minute of it.
+	    if (first) {
+		now = f.ms;
+	    } else {
+		lost += (uint8_t) (f.seq - seq - 1);
+		now += (uint16_t) (f.ms - ms);
+	    }
+	    printf("%llu,%u,%u,%u,%d,%d,%d,%d,%d,%d,%u,%u\n", now, f.seq,
+		   f.state, f.inputs, f.joyx, f.joyy, f.vbat, f.venbl,
+		   f.left, f.right, f.tickMax,
+		   first ? 0 : (uint8_t) (f.overruns - overruns));
+	    first = false;
+	    seq = f.seq;
+	    ms = f.ms;
+	    overruns = f.overruns;
+	    frames++;
+	}
+    }
+
+    fflush(stdout);
+    fprintf(stderr, "telemrx: %lu frames, %lu bad, %lu lost\n",
+	    frames, bad, lost);
+    return 0;
+}